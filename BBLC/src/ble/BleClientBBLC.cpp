@@ -1,18 +1,42 @@
 #include "BleClientBBLC.h"
 #include "esp_log.h"
 
-static const char* TAG = "BLE";
+#include "ble/BblhGattNimBLE.h"
+#include "ble/BleProtocol.h"
+#include "ble/PeerTable.h"
+#include "ble/BleTxPower.h"
 
-// UUIDs attendus cote BBLH
-static const NimBLEUUID BBLH_SERVICE_UUID("a1b2c3d4-0001-4000-8000-000000000001");
-static const NimBLEUUID BBLH_CMD_UUID("a1b2c3d4-0002-4000-8000-000000000001");
-static const NimBLEUUID BBLH_STATUS_UUID("a1b2c3d4-0003-4000-8000-000000000001");
+static const char* TAG = "BLE";
 
-namespace {
-// Trampoline pour les notifications STATUS
-void statusNotifyTrampoline(NimBLERemoteCharacteristic* chr, uint8_t* data, size_t len, bool isNotify) {
-    BleClientBBLC::onStatusNotify(chr, data, len, isNotify);
-}
+// Periode d'echantillonnage RSSI / qualite de lien
+static constexpr uint32_t LINK_SAMPLE_PERIOD_MS = 500;
+
+// MTU ATT demande a l'echange qui suit chaque connexion. L'echange n'a
+// lieu qu'une fois par lien : le benchmark mesure donc toujours ce MTU.
+static constexpr uint16_t PREFERRED_MTU = 247;
+
+// Benchmark : duree max d'une rafale dans loop() et attente du rapport BBLH
+static constexpr uint32_t BENCH_SLICE_MS = 20;
+static constexpr uint32_t BENCH_REPORT_TIMEOUT_MS = 2000;
+
+// Seules des tetes bloquees par leur disjoncteur autour : pause du scan
+// (en DISCONNECTED, donc sommeil possible) jusqu'a la reouverture la plus
+// proche, bornee pour entendre quand meme une nouvelle tete
+static constexpr uint32_t BLOCKED_SCAN_PAUSE_MAX_MS = 10000;
+
+// Cause d'un echec de connect() d'apres le code NimBLE : refus explicite
+// du pair, sinon timeout (portee, collisions, tete absente)
+static ConnectFailure classifyConnectError(int err) {
+    switch (err) {
+        case BLE_HS_ERR_HCI_BASE + BLE_ERR_REM_USER_CONN_TERM:
+        case BLE_HS_ERR_HCI_BASE + BLE_ERR_CONN_LIMIT:
+        case BLE_HS_ERR_HCI_BASE + BLE_ERR_CONN_REJ_RESOURCES:
+        case BLE_HS_ERR_HCI_BASE + BLE_ERR_CONN_REJ_SECURITY:
+        case BLE_HS_ERR_HCI_BASE + BLE_ERR_CONN_REJ_BD_ADDR:
+            return ConnectFailure::REJECTED;
+        default:
+            return ConnectFailure::TIMEOUT;
+    }
 }
 
 // ==========================
@@ -27,32 +51,37 @@ BleClientBBLC::BleClientBBLC()
 // ==========================
 void BleClientBBLC::begin() {
     NimBLEDevice::init("BBLC");
-    NimBLEDevice::setPower(ESP_PWR_LVL_P9);
+    NimBLEDevice::setMTU(PREFERRED_MTU);
+    resetTxPower();
 
     scan_ = NimBLEDevice::getScan();
     scan_->setScanCallbacks(&scanCallbacks_, false);
     scan_->setInterval(45);
     scan_->setWindow(15);
     scan_->setActiveScan(true);
+    scan_->setDuplicateFilter(false);   // chaque annonce compte pour le RSSI filtre
 
-    setState(BleState::BOOT);
+    // Graine differente par carte : les BBLC d'une salle ne retentent pas ensemble
+    reconnect_.seed(esp_random());
+
+    sm_.onTransition([this](BleState from, BleState to, BleEvent event) {
+        onTransition(from, to, event);
+    });
+    sm_.begin(millis());
 }
 
 void BleClientBBLC::loop() {
+    drainEvents();        // coupures vues par la tache NimBLE
+    drainStatusFrames();  // trames STATUS recues par la tache NimBLE
+    sm_.poll(millis());   // timeouts CONNECTING / DISCONNECTED / ERROR
+    selectHead();
     connectIfPending();
+    updateLinkQuality();
+    runBenchmark();
 }
 
 void BleClientBBLC::startScan() {
-    ESP_LOGI(TAG, "Start scanning");
-
-    pendingConnect_ = false;
-    scan_->stop();               // eviter les overlaps de scan
-    scan_->clearResults();       // optionnel mais sain
-    seenAdvertisers_.clear();
-
-    scan_->start(0, false);
-
-    setState(BleState::SCANNING);
+    dispatch(BleEvent::START);   // le travail est fait a l'entree de SCANNING
 }
 
 void BleClientBBLC::disconnect() {
@@ -62,13 +91,77 @@ void BleClientBBLC::disconnect() {
 }
 
 BleState BleClientBBLC::getState() const {
-    return state_;
+    return sm_.state();
+}
+
+bool BleClientBBLC::isBusy() const {
+    const BleState state = sm_.state();
+    return pendingConnect_ ||
+           state == BleState::SCANNING ||
+           state == BleState::CONNECTING ||
+           isBenchmarkRunning();
+}
+
+uint32_t BleClientBBLC::msUntilNextWork(uint32_t now) const {
+    if (!events_.empty() || !statusFrames_.empty()) {
+        return 0;
+    }
+    if (sm_.state() == BleState::SCANNING) {
+        return selector_.msUntilDecision(now);   // fin de la fenetre de selection
+    }
+    if (sm_.state() != BleState::CONNECTED) {
+        return sm_.msUntilTimeout(now);   // reprise apres DISCONNECTED / ERROR
+    }
+
+    const uint32_t elapsed = now - lastLinkSampleMs_;
+    return elapsed >= LINK_SAMPLE_PERIOD_MS ? 0 : LINK_SAMPLE_PERIOD_MS - elapsed;
 }
 
 void BleClientBBLC::onStateChange(StateCallback cb) {
     stateCallback_ = cb;
 }
 
+void BleClientBBLC::onBenchmarkReport(BenchReportCallback cb) {
+    benchCb_ = cb;
+}
+
+void BleClientBBLC::onLaunchLog(LaunchLogCallback cb) {
+    launchLogCb_ = cb;
+}
+
+bool BleClientBBLC::requestLaunchLog(uint32_t fromSeq) {
+    if (!chrLog_) {
+        ESP_LOGW(TAG, "Launch log not supported by this BBLH");
+        return false;
+    }
+
+    uint8_t frame[5];
+    frame[0] = static_cast<uint8_t>(BleProto::Op::LOG_EXPORT);
+    BleProto::putU32(frame + 1, fromSeq);
+    return sendCommand(frame, sizeof(frame), true);
+}
+
+void BleClientBBLC::onBootReport(BootReportCallback cb) {
+    bootReportCb_ = cb;
+}
+
+bool BleClientBBLC::requestBootReport() {
+    const uint8_t frame = static_cast<uint8_t>(BleProto::Op::BOOT_REPORT);
+    return sendCommand(&frame, 1, true);
+}
+
+bool BleClientBBLC::sendFire(uint8_t profile, uint8_t strength, uint32_t gestureUs) {
+    uint8_t frame[BleProto::FIRE_GESTURE_FRAME_LEN];
+    frame[0] = static_cast<uint8_t>(BleProto::Op::FIRE);
+    frame[1] = profile;
+    frame[2] = strength;
+    // Age du geste au moment de l'ecriture, calcule en dernier
+    BleProto::putU32(frame + 3, micros() - gestureUs);
+
+    // Sans reponse : pas d'aller-retour ATT sur le chemin du tir
+    return sendCommand(frame, sizeof(frame), false);
+}
+
 bool BleClientBBLC::sendCommand(const uint8_t* data, size_t len, bool response) {
     if (!chrCmd_ || !client_ || !client_->isConnected()) {
         ESP_LOGW(TAG, "sendCommand: client not ready");
@@ -76,6 +169,13 @@ bool BleClientBBLC::sendCommand(const uint8_t* data, size_t len, bool response)
     }
 
     bool ok = chrCmd_->writeValue(data, len, response);
+    if (!ok && response) {
+        // Une seule nouvelle tentative, comptee pour la qualite de lien
+        linkMonitor_.addRetry();
+        ok = chrCmd_->writeValue(data, len, response);
+    }
+    linkMonitor_.addTxResult(ok);
+
     ESP_LOGI(TAG, "Send CMD (%u bytes) -> %s", static_cast<unsigned>(len), ok ? "ok" : "fail");
     return ok;
 }
@@ -83,18 +183,248 @@ bool BleClientBBLC::sendCommand(const uint8_t* data, size_t len, bool response)
 // ==========================
 // Internal logic
 // ==========================
-void BleClientBBLC::setState(BleState newState) {
-    if (state_ == newState) {
-        return;
+bool BleClientBBLC::dispatch(BleEvent event) {
+    if (sm_.dispatch(event, millis())) {
+        return true;
     }
 
-    state_ = newState;
+    ESP_LOGW(TAG, "Event %s ignored in state %s",
+             bleEventToString(event), bleStateToString(sm_.state()));
+    return false;
+}
 
-    ESP_LOGI(TAG, "State -> %d", static_cast<int>(state_));
+void BleClientBBLC::drainEvents() {
+    BleEvent event;
+    while (events_.pop(event)) {
+        // Deja traite par loop() (echec de connect / setup, ERROR) : perime
+        if (!sm_.accepts(event)) {
+            ESP_LOGD(TAG, "Stale %s in state %s", bleEventToString(event), bleStateToString(sm_.state()));
+            continue;
+        }
+        if (event == BleEvent::LINK_LOST) {
+            noteLinkLost();
+        }
+        dispatch(event);
+    }
+}
 
+void BleClientBBLC::drainStatusFrames() {
+    StatusFrame frame;
+    while (statusFrames_.pop(frame)) {
+        const uint8_t* data = frame.data;
+        const size_t len = frame.len;
+        const auto op = static_cast<BleProto::Op>(data[0]);
+
+        if (op == BleProto::Op::LINK_TX && len >= 2) {
+            peerTxDbm_ = static_cast<int8_t>(data[1]);
+            ESP_LOGD(TAG, "Peer TX power = %d dBm", peerTxDbm_);
+        } else if (op == BleProto::Op::BENCH_DATA) {
+            bench_.onFrame(data, len);   // ne lit que l'en-tete
+        } else if (op == BleProto::Op::BENCH_REPORT) {
+            BleBench::Report peer;
+            if (!benchAwaitingReport_ || !BleBench::decodeReport(data + 1, len - 1, peer)) {
+                ESP_LOGW(TAG, "Benchmark: unexpected report");
+                continue;
+            }
+            benchAwaitingReport_ = false;
+
+            const BleBench::Report local =
+                bench_.report(BleBench::Role::CLIENT, client_ ? client_->getMTU() : 0);
+            const BleBench::Stats& tx =
+                local.config.direction == BleBench::Direction::WRITE ? local.stats : peer.stats;
+            const BleBench::Stats& rx =
+                local.config.direction == BleBench::Direction::WRITE ? peer.stats : local.stats;
+
+            ESP_LOGI(TAG, "Benchmark done: %lu ops ok, %lu failed, %lu lost, %lu B/s, cpu %lu us",
+                     static_cast<unsigned long>(tx.opsOk),
+                     static_cast<unsigned long>(tx.opsFailed),
+                     static_cast<unsigned long>(rx.rxLost),
+                     static_cast<unsigned long>(rx.goodputBps()),
+                     static_cast<unsigned long>(tx.cpuUs));
+
+            if (benchCb_) {
+                benchCb_(local, peer);
+            }
+        }
+    }
+}
+
+// Lien etabli perdu : reprise etalee (backoff s'il a flanche tout de suite).
+// Une coupure pendant connect() / le setup est deja comptee par
+// connectIfPending(), qui a quitte CONNECTING avant que loop() la voie.
+void BleClientBBLC::noteLinkLost() {
+    const uint32_t now = millis();
+    portENTER_CRITICAL(&selectMux_);
+    if (!retryPlanned_) {
+        retryDelayMs_ = reconnect_.onLinkLost(targetAddress_, now);
+        retryPlanned_ = true;
+    }
+    portEXIT_CRITICAL(&selectMux_);
+}
+
+// Actions d'entree d'etat : la table decide, ici on execute
+void BleClientBBLC::onTransition(BleState from, BleState to, BleEvent event) {
+    ESP_LOGI(TAG, "State %s -> %s (%s)",
+             bleStateToString(from), bleStateToString(to), bleEventToString(event));
+
+    if (to != BleState::CONNECTED) {
+        connIntervalMs_ = 0;
+    }
+
+    // LED d'abord : une action d'entree peut enchainer une autre transition
     if (stateCallback_) {
-        stateCallback_(state_);
+        stateCallback_(to);
+    }
+
+    switch (to) {
+        case BleState::SCANNING:
+            enterScanning();
+            break;
+
+        case BleState::ERROR:
+            if (client_ && client_->isConnected()) {
+                client_->disconnect();
+            }
+            // fallthrough
+        case BleState::DISCONNECTED: {
+            pendingConnect_ = false;
+            abortBenchmark();
+
+            // Delai de reprise de la politique de reconnexion ; ERROR reste
+            // visible au moins le temps prevu par la table
+            portENTER_CRITICAL(&selectMux_);
+            const bool planned = retryPlanned_;
+            const uint32_t delayMs = retryDelayMs_;
+            retryPlanned_ = false;
+            portEXIT_CRITICAL(&selectMux_);
+
+            if (planned && (to == BleState::DISCONNECTED || delayMs > sm_.timeoutMs(to))) {
+                sm_.setStateTimeout(delayMs);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void BleClientBBLC::enterScanning() {
+    ESP_LOGI(TAG, "Start scanning");
+
+    pendingConnect_ = false;
+    abortBenchmark();
+    resetTxPower();              // scan / connexion a pleine puissance
+    scan_->stop();               // eviter les overlaps de scan
+    scan_->clearResults();       // optionnel mais sain
+    seenAdvertisers_.clear();
+
+    portENTER_CRITICAL(&selectMux_);
+    selector_.begin(millis());
+    blockedHeard_ = false;
+    retryPlanned_ = false;
+    portEXIT_CRITICAL(&selectMux_);
+
+    scan_->start(0, false);
+}
+
+// Fenetre de selection : on se connecte a la tete la plus proche, pas a la premiere entendue
+void BleClientBBLC::selectHead() {
+    if (sm_.state() != BleState::SCANNING || pendingConnect_) {
+        return;
+    }
+
+    const uint32_t now = millis();
+    bool picked = false;
+    NimBLEAddress address;
+    int8_t rssi = 0;
+    uint32_t selectionMs = 0;
+    bool early = false;
+    size_t candidates = 0;
+    bool paused = false;
+    uint32_t pauseMs = 0;
+
+    portENTER_CRITICAL(&selectMux_);
+    const HeadSelectResult result = selector_.poll(now);
+    if (result == HeadSelectResult::PICKED) {
+        const auto* head = selector_.picked();
+        picked = head != nullptr;
+        if (picked) {
+            address = head->address;
+            rssi = head->rssiDbm();
+            selectionMs = selector_.selectionMs();
+            early = selector_.pickedEarly();
+            candidates = selector_.candidates();
+            reconnect_.setCrowd(static_cast<uint16_t>(candidates));   // etalement apres une coupure
+        }
+    } else if (result == HeadSelectResult::EMPTY) {
+        // Personne d'eligible. Si des tetes ont ete ecartees par leur
+        // disjoncteur, scanner ne sert a rien avant sa reouverture
+        paused = blockedHeard_;
+        if (paused) {
+            const int32_t left = static_cast<int32_t>(blockedUntilMs_ - now);
+            pauseMs = left <= 0 ? 0 : static_cast<uint32_t>(left);
+            if (pauseMs > BLOCKED_SCAN_PAUSE_MAX_MS) pauseMs = BLOCKED_SCAN_PAUSE_MAX_MS;
+            retryDelayMs_ = pauseMs;
+            retryPlanned_ = true;
+        }
+        selector_.begin(now);   // sinon nouvelle fenetre, le scan continue
+        blockedHeard_ = false;
+    }
+    portEXIT_CRITICAL(&selectMux_);
+
+    if (paused) {
+        ESP_LOGI(TAG, "Only breaker-blocked heads around, scan paused %lu ms",
+                 static_cast<unsigned long>(pauseMs));
+        scan_->stop();
+        dispatch(BleEvent::LINK_FAILED);   // DISCONNECTED, rescan au timeout
+        return;
+    }
+    if (!picked) {
+        return;
     }
+
+    selectStats_.add(selectionMs);
+    ESP_LOGI(TAG, "Head selected: %s rssi=%d dBm after %lu ms (%u candidates, %s)",
+             address.toString().c_str(), rssi,
+             static_cast<unsigned long>(selectionMs),
+             static_cast<unsigned>(candidates),
+             early ? "early" : "window end");
+
+    scan_->stop();
+    requestConnect(address);
+}
+
+void BleClientBBLC::logStateStats() const {
+    const uint32_t now = millis();
+    ESP_LOGI(TAG, "State %s since %lu ms, %lu rejected events",
+             bleStateToString(sm_.state()),
+             static_cast<unsigned long>(sm_.timeInStateMs(now)),
+             static_cast<unsigned long>(sm_.rejectedCount()));
+    ESP_LOGI(TAG, "Head selection: n=%lu avg=%lu ms max=%lu ms",
+             static_cast<unsigned long>(selectStats_.count),
+             static_cast<unsigned long>(selectStats_.avgMs()),
+             static_cast<unsigned long>(selectStats_.maxMs));
+
+    portENTER_CRITICAL(&selectMux_);
+    const ReconnectStats rs = reconnect_.stats();
+    const uint8_t attempts = reconnect_.attempts();
+    portEXIT_CRITICAL(&selectMux_);
+    ESP_LOGI(TAG, "Reconnect: timeout=%lu service_missing=%lu rejected=%lu lost=%lu breaker=%lu backoff=%u",
+             static_cast<unsigned long>(rs.failures[static_cast<size_t>(ConnectFailure::TIMEOUT)]),
+             static_cast<unsigned long>(rs.failures[static_cast<size_t>(ConnectFailure::SERVICE_MISSING)]),
+             static_cast<unsigned long>(rs.failures[static_cast<size_t>(ConnectFailure::REJECTED)]),
+             static_cast<unsigned long>(rs.linksLost),
+             static_cast<unsigned long>(rs.breakerTrips),
+             static_cast<unsigned>(attempts));
+
+    sm_.forEachTakenEdge([](BleState from, BleEvent event, BleState to, const BleDwellStats& d) {
+        ESP_LOGI(TAG, "  %s -%s-> %s: n=%lu avg=%lu ms max=%lu ms",
+                 bleStateToString(from), bleEventToString(event), bleStateToString(to),
+                 static_cast<unsigned long>(d.count),
+                 static_cast<unsigned long>(d.avgMs()),
+                 static_cast<unsigned long>(d.maxMs));
+    });
 }
 
 void BleClientBBLC::requestConnect(const NimBLEAddress& address) {
@@ -108,7 +438,10 @@ void BleClientBBLC::connectIfPending() {
     }
 
     pendingConnect_ = false;
-    setState(BleState::CONNECTING);
+    if (!dispatch(BleEvent::PEER_FOUND)) {
+        return;
+    }
+    attemptOpen_ = true;
 
     if (client_) {
         NimBLEDevice::deleteClient(client_);
@@ -117,27 +450,208 @@ void BleClientBBLC::connectIfPending() {
 
     client_ = NimBLEDevice::createClient();
     client_->setClientCallbacks(&clientCallbacks_);
+    // connect() est bloquant : la pile borne l'attente au timeout de CONNECTING
+    client_->setConnectTimeout(sm_.timeoutMs(BleState::CONNECTING));
 
     ESP_LOGI(TAG, "Connecting to %s", targetAddress_.toString().c_str());
 
     if (!client_->connect(targetAddress_)) {
-        ESP_LOGE(TAG, "Connection failed");
+        const int err = client_->getLastError();
+        ESP_LOGE(TAG, "Connection failed (err=%d)", err);
         NimBLEDevice::deleteClient(client_);
         client_ = nullptr;
-        setState(BleState::DISCONNECTED);
-        startScan();
+        recordFailure(classifyConnectError(err));
+        dispatch(BleEvent::LINK_FAILED);   // nouveau scan apres le backoff, en DISCONNECTED
         return;
     }
 
     if (!setupRemoteCharacteristics()) {
-        ESP_LOGE(TAG, "Remote setup failed, restart scan");
-        client_->disconnect();
-        setState(BleState::ERROR);
-        startScan();
+        ESP_LOGE(TAG, "Remote setup failed");
+        // Toujours connecte : ce n'est pas un BBLH utilisable. Sinon la tete a coupe
+        recordFailure(client_->isConnected() ? ConnectFailure::SERVICE_MISSING
+                                             : ConnectFailure::REJECTED);
+        dispatch(BleEvent::FAULT);         // deconnexion a l'entree d'ERROR
+        return;
+    }
+
+    portENTER_CRITICAL(&selectMux_);
+    attemptOpen_ = false;
+    reconnect_.onConnected(millis());
+    portEXIT_CRITICAL(&selectMux_);
+
+    // Annonce du role : seul le CONTROLLER peut envoyer FIRE a BBLH
+    const uint8_t hello[] = {
+        static_cast<uint8_t>(BleProto::Op::HELLO),
+        static_cast<uint8_t>(PeerRole::CONTROLLER),
+    };
+    sendCommand(hello, sizeof(hello), true);
+
+    linkMonitor_.reset();
+    lastLinkSampleMs_ = millis();
+    publishTxPower();
+
+    // Lien tombe pendant le setup : le LINK_LOST en attente le traitera
+    dispatch(BleEvent::LINK_UP);
+    updateConnInterval();
+}
+
+// Compte l'echec de la tentative en cours (une seule fois) et prepare le
+// delai de reprise
+void BleClientBBLC::recordFailure(ConnectFailure cause) {
+    const uint32_t now = millis();
+
+    portENTER_CRITICAL(&selectMux_);
+    const bool counted = attemptOpen_;
+    attemptOpen_ = false;
+    if (counted) {
+        retryDelayMs_ = reconnect_.onFailure(targetAddress_, cause, now);
+        retryPlanned_ = true;
+    }
+    const uint32_t delayMs = retryDelayMs_;
+    const bool blocked = !reconnect_.allows(targetAddress_, now);
+    portEXIT_CRITICAL(&selectMux_);
+
+    if (!counted) {
         return;
     }
+    ESP_LOGW(TAG, "Connect to %s failed: %s, retry in %lu ms%s",
+             targetAddress_.toString().c_str(), connectFailureToString(cause),
+             static_cast<unsigned long>(delayMs),
+             blocked ? " (head blocked by breaker)" : "");
+}
+
+// ==========================
+// Adaptive TX power
+// ==========================
+void BleClientBBLC::updateLinkQuality() {
+    if (sm_.state() != BleState::CONNECTED || !client_ || !client_->isConnected()) {
+        return;
+    }
+
+    const uint32_t now = millis();
+    if (now - lastLinkSampleMs_ < LINK_SAMPLE_PERIOD_MS) {
+        return;
+    }
+    lastLinkSampleMs_ = now;
+    updateConnInterval();   // BBLH peut renegocier les parametres
+
+    const int rssi = client_->getRssi();
+    if (rssi != 0) {   // 0 = lecture RSSI impossible
+        linkMonitor_.addRssi(static_cast<int8_t>(rssi));
+    }
 
-    setState(BleState::CONNECTED);
+    const LinkQualitySnapshot q = linkMonitor_.snapshot();
+    if (txPower_.update(q, peerTxDbm_)) {
+        bleApplyTxPowerLevel(txPower_.level());
+        ESP_LOGI(TAG, "TX power -> %d dBm (rssi=%d, err=%u/1000, ~%u mA)",
+                 txPower_.dbm(), q.rssiDbm,
+                 static_cast<unsigned>(q.errorPermille),
+                 static_cast<unsigned>(txPower_.currentMa()));
+        publishTxPower();
+    }
+
+    linkMonitor_.startWindow();
+}
+
+void BleClientBBLC::updateConnInterval() {
+    // Unites de 1,25 ms
+    connIntervalMs_ = client_->getConnInfo().getConnInterval() * 5u / 4u;
+}
+
+void BleClientBBLC::resetTxPower() {
+    txPower_.reset();
+    linkMonitor_.reset();
+    peerTxDbm_ = TX_POWER_LEVELS[TX_POWER_LEVEL_MAX].dbm;
+    bleApplyTxPowerLevel(txPower_.level());
+}
+
+void BleClientBBLC::publishTxPower() {
+    const uint8_t frame[] = {
+        static_cast<uint8_t>(BleProto::Op::LINK_TX),
+        static_cast<uint8_t>(txPower_.dbm()),
+    };
+    sendCommand(frame, sizeof(frame), false);
+}
+
+// ==========================
+// Throughput benchmark
+// ==========================
+bool BleClientBBLC::startBenchmark(const BleBench::Config& config) {
+    if (sm_.state() != BleState::CONNECTED || !chrCmd_ || isBenchmarkRunning()) {
+        ESP_LOGW(TAG, "Benchmark: client not ready");
+        return false;
+    }
+
+    if (config.phy >= 1 && config.phy <= 3) {
+        const uint8_t phyMask = static_cast<uint8_t>(1u << (config.phy - 1));
+        ble_gap_set_prefered_le_phy(client_->getConnHandle(), phyMask, phyMask,
+                                    BLE_GAP_LE_PHY_CODED_ANY);
+    }
+
+    bench_.start(config, millis(), client_->getMTU() - 3);
+
+    uint8_t frame[1 + BleBench::CONFIG_SIZE];
+    frame[0] = static_cast<uint8_t>(BleProto::Op::BENCH_START);
+    BleBench::encodeConfig(bench_.config(), frame + 1);
+
+    if (!chrCmd_->writeValue(frame, sizeof(frame), true)) {
+        ESP_LOGE(TAG, "Benchmark: START rejected");
+        bench_.stop(millis());
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Benchmark start: dir=%u payload=%u mtu=%u phy=%u %u ms",
+             static_cast<unsigned>(bench_.config().direction),
+             static_cast<unsigned>(bench_.config().payloadSize),
+             static_cast<unsigned>(client_->getMTU()),
+             static_cast<unsigned>(config.phy),
+             static_cast<unsigned>(config.durationMs));
+    return true;
+}
+
+void BleClientBBLC::runBenchmark() {
+    const uint32_t now = millis();
+
+    if (benchAwaitingReport_) {
+        if (now - benchStopMs_ > BENCH_REPORT_TIMEOUT_MS) {
+            ESP_LOGW(TAG, "Benchmark: no report from BBLH");
+            benchAwaitingReport_ = false;
+        }
+        return;
+    }
+
+    if (!bench_.running()) {
+        return;
+    }
+
+    if (!bench_.sending(now)) {
+        bench_.stop(now);
+        const uint8_t stop = static_cast<uint8_t>(BleProto::Op::BENCH_STOP);
+        benchAwaitingReport_ = chrCmd_->writeValue(&stop, 1, true);
+        benchStopMs_ = now;
+        return;
+    }
+
+    if (bench_.config().direction != BleBench::Direction::WRITE) {
+        return;   // BBLH envoie, on compte dans onStatusNotify
+    }
+
+    // Rafale bornee pour ne pas affamer le reste de loop()
+    static uint8_t frame[BLE_ATT_ATTR_MAX_LEN];
+    const bool response = bench_.config().writeType == BleBench::WriteType::WITH_RESPONSE;
+    const uint32_t sliceStart = millis();
+
+    while (millis() - sliceStart < BENCH_SLICE_MS && bench_.sending(millis())) {
+        const size_t len = bench_.nextFrame(frame);
+        const uint32_t t0 = micros();
+        const bool ok = chrCmd_->writeValue(frame, len, response);
+        bench_.recordSend(ok, len, micros() - t0);
+    }
+}
+
+void BleClientBBLC::abortBenchmark() {
+    bench_.stop(millis());
+    benchAwaitingReport_ = false;
 }
 
 // ==========================
@@ -149,11 +663,33 @@ BleClientBBLC::ScanCallbacks::ScanCallbacks(BleClientBBLC& parent)
 void BleClientBBLC::ScanCallbacks::onResult(
     const NimBLEAdvertisedDevice* device
 ) {
-    if (parent_.state_ != BleState::SCANNING) {
+    if (parent_.sm_.state() != BleState::SCANNING) {
         return;
     }
 
-    bool isNew = parent_.updateAdvertiser(device);
+    const BleAdvertiserInfo* info = nullptr;
+    const bool isNew = parent_.updateAdvertiser(device, &info);
+
+    // Candidat BBLH : service annonce ou nom. Chaque annonce alimente la
+    // selection, la decision est prise dans loop() (selectHead)
+    const bool matchService = device->isAdvertisingService(BblhGatt::serviceUuid());
+    const bool matchName = device->haveName() && device->getName() == "BBLH";
+
+    if (matchService || matchName) {
+        const uint32_t now = millis();
+        portENTER_CRITICAL(&parent_.selectMux_);
+        // Disjoncteur ouvert : la tete est ignoree jusqu'a sa prochaine chance
+        const uint32_t blockedMs = parent_.reconnect_.msUntilAllowed(info->address, now);
+        if (!blockedMs) {
+            parent_.selector_.observe(info->address, static_cast<int8_t>(info->rssi),
+                                      info->hasStatus ? &info->status : nullptr);
+        } else if (!parent_.blockedHeard_ ||
+                   static_cast<int32_t>(now + blockedMs - parent_.blockedUntilMs_) < 0) {
+            parent_.blockedHeard_ = true;
+            parent_.blockedUntilMs_ = now + blockedMs;   // reouverture la plus proche
+        }
+        portEXIT_CRITICAL(&parent_.selectMux_);
+    }
 
     if (!isNew) {
         return;
@@ -167,17 +703,17 @@ void BleClientBBLC::ScanCallbacks::onResult(
     ESP_LOGI(TAG, "  ServiceData: %d", device->haveServiceData());
     ESP_LOGI(TAG, "  ManufacturerData: %d", device->haveManufacturerData());
 
+    if (info->hasStatus) {
+        ESP_LOGI(TAG, "  Status: flags=0x%02x battery=%u fw=%u.%u",
+                 info->status.flags, info->status.batteryPct,
+                 info->status.fwMajor, info->status.fwMinor);
+    }
+
     ESP_LOGI(TAG, "[BLE] Total advertisers: %d",
              parent_.seenAdvertisers_.size());
 
-    // Auto-connect si le service BBLH est annonce ou si le nom correspond
-    const bool matchService = device->isAdvertisingService(BBLH_SERVICE_UUID);
-    const bool matchName = device->haveName() && device->getName() == "BBLH";
-
     if (matchService || matchName) {
-        ESP_LOGI(TAG, "BBLH service detected, preparing connection");
-        parent_.scan_->stop();
-        parent_.requestConnect(device->getAddress());
+        ESP_LOGI(TAG, "BBLH candidate, head selection in progress");
     }
 }
 
@@ -191,20 +727,29 @@ void BleClientBBLC::ClientCallbacks::onConnect(NimBLEClient*) {
     ESP_LOGI(TAG, "Connected (link up)");
 }
 
+// Tache NimBLE : on poste, loop() fait la transition puis rescanne apres le delai
 void BleClientBBLC::ClientCallbacks::onDisconnect(NimBLEClient*) {
     ESP_LOGI(TAG, "Disconnected");
-    parent_.setState(BleState::DISCONNECTED);
-    parent_.startScan();
+
+    if (!parent_.events_.post(BleEvent::LINK_LOST)) {
+        ESP_LOGE(TAG, "BLE event queue full, LINK_LOST dropped");
+    }
 }
 
 // ==========================
 // Advertiser cache
 // ==========================
 bool BleClientBBLC::updateAdvertiser(
-    const NimBLEAdvertisedDevice* device
+    const NimBLEAdvertisedDevice* device,
+    const BleAdvertiserInfo** entry
 ) {
     const NimBLEAddress& addr = device->getAddress();
 
+    // Statut BBLH lu directement dans le buffer de l'annonce, sans copie
+    const std::vector<uint8_t>& payload = device->getPayload();
+    AdvStatus status;
+    const bool hasStatus = parseAdvStatus(payload.data(), payload.size(), status);
+
     for (auto& adv : seenAdvertisers_) {
         if (adv.address == addr) {
             adv.rssi = device->getRSSI();
@@ -218,6 +763,12 @@ bool BleClientBBLC::updateAdvertiser(
             adv.hasServiceData      = device->haveServiceData();
             adv.hasManufacturerData = device->haveManufacturerData();
 
+            if (hasStatus) {
+                adv.hasStatus = true;
+                adv.status = status;
+            }
+
+            *entry = &adv;
             return false; // deja connu
         }
     }
@@ -231,9 +782,13 @@ bool BleClientBBLC::updateAdvertiser(
     info.hasServiceData      = device->haveServiceData();
     info.hasManufacturerData = device->haveManufacturerData();
 
+    info.hasStatus = hasStatus;
+    info.status = status;
+
     info.lastSeenMs = millis();
 
     seenAdvertisers_.push_back(info);
+    *entry = &seenAdvertisers_.back();
     return true; // nouveau
 }
 
@@ -241,37 +796,108 @@ bool BleClientBBLC::updateAdvertiser(
 // Remote setup / notifications
 // ==========================
 bool BleClientBBLC::setupRemoteCharacteristics() {
-    bblhService_ = client_ ? client_->getService(BBLH_SERVICE_UUID) : nullptr;
-    if (!bblhService_) {
-        ESP_LOGE(TAG, "BBLH service not found on peripheral");
-        return false;
-    }
-
-    chrCmd_ = bblhService_->getCharacteristic(BBLH_CMD_UUID);
-    chrStatus_ = bblhService_->getCharacteristic(BBLH_STATUS_UUID);
+    // Handles lies en une passe depuis le schema commun (BblhGattSchema.h)
+    NimBLERemoteCharacteristic* chars[BblhGatt::CHAR_COUNT];
+    bblhService_ = BblhGatt::bindClient(client_, chars);
+    chrCmd_ = chars[static_cast<size_t>(BblhGatt::CharId::CMD)];
+    chrStatus_ = chars[static_cast<size_t>(BblhGatt::CharId::STATUS)];
+    chrLog_ = chars[static_cast<size_t>(BblhGatt::CharId::LOG)];
 
-    if (!chrCmd_ || !chrStatus_) {
-        ESP_LOGE(TAG, "Missing CMD or STATUS characteristic");
+    if (!bblhService_) {
+        ESP_LOGE(TAG, "BBLH service or required characteristic missing");
         return false;
     }
 
     if (chrStatus_->canNotify() || chrStatus_->canIndicate()) {
-        if (!chrStatus_->subscribe(true, statusNotifyTrampoline)) {
+        auto onNotify = [this](NimBLERemoteCharacteristic* chr, uint8_t* data, size_t len, bool isNotify) {
+            onStatusNotify(chr, data, len, isNotify);
+        };
+        if (!chrStatus_->subscribe(true, onNotify)) {
             ESP_LOGW(TAG, "Failed to subscribe to STATUS notifications");
         }
     } else {
         ESP_LOGW(TAG, "STATUS characteristic has no notify/indicate");
     }
 
+    if (chrLog_ && chrLog_->canNotify()) {
+        auto onLog = [this](NimBLERemoteCharacteristic*, uint8_t* data, size_t len, bool) {
+            onLogNotify(data, len);
+        };
+        if (!chrLog_->subscribe(true, onLog)) {
+            ESP_LOGW(TAG, "Failed to subscribe to LOG notifications");
+            chrLog_ = nullptr;
+        }
+    }
+
     ESP_LOGI(TAG, "Remote characteristics ready");
     return true;
 }
 
+// Lot d'historique : [flags][count][count * LaunchRecord]
+void BleClientBBLC::onLogNotify(const uint8_t* data, size_t len) {
+    static constexpr size_t MAX_PER_BATCH =
+        (BLE_ATT_ATTR_MAX_LEN - BleProto::LOG_BATCH_HEADER) / LAUNCH_RECORD_SIZE;
+
+    if (len < BleProto::LOG_BATCH_HEADER) {
+        return;
+    }
+
+    size_t count = data[1];
+    if (count > MAX_PER_BATCH ||
+        len < BleProto::LOG_BATCH_HEADER + count * LAUNCH_RECORD_SIZE) {
+        ESP_LOGW(TAG, "Malformed LOG batch (%u bytes)", static_cast<unsigned>(len));
+        return;
+    }
+
+    // Copie alignee avant decodage
+    LaunchRecord records[MAX_PER_BATCH];
+    memcpy(records, data + BleProto::LOG_BATCH_HEADER, count * LAUNCH_RECORD_SIZE);
+
+    const bool last = data[0] & BleProto::LOG_BATCH_LAST;
+    if (launchLogCb_) {
+        launchLogCb_(records, count, last);
+    }
+}
+
 void BleClientBBLC::onStatusNotify(NimBLERemoteCharacteristic* chr, uint8_t* data, size_t len, bool isNotify) {
     (void)chr;
+
+    if (BleProto::isBinaryFrame(data, len)) {
+        const auto op = static_cast<BleProto::Op>(data[0]);
+        if (op == BleProto::Op::BOOT_REPORT) {
+            BootTimeline head;
+            if (!head.decode(data + 1, len - 1)) {
+                ESP_LOGW(TAG, "Boot report: bad frame");
+                return;
+            }
+            if (bootReportCb_) {
+                bootReportCb_(head);
+            }
+        } else if (op == BleProto::Op::LINK_TX || op == BleProto::Op::BENCH_DATA ||
+                   op == BleProto::Op::BENCH_REPORT) {
+            StatusFrame frame;
+            frame.len = static_cast<uint16_t>(len);
+            memcpy(frame.data, data, len < sizeof(frame.data) ? len : sizeof(frame.data));
+            if (!statusFrames_.post(frame)) {
+                ESP_LOGW(TAG, "STATUS queue full, frame 0x%02x dropped", static_cast<unsigned>(data[0]));
+            }
+        }
+        return;
+    }
+
     ESP_LOGI(TAG, "STATUS %s (%u bytes): %.*s",
         isNotify ? "notify" : "indicate",
         static_cast<unsigned>(len),
         static_cast<int>(len),
         reinterpret_cast<const char*>(data));
+
+    // Role CONTROLLER refuse : inutile de rester, on laisse la place et on recule
+    static const char denied[] = "ROLE_DENIED";
+    if (len == sizeof(denied) - 1 && memcmp(data, denied, len) == 0) {
+        portENTER_CRITICAL(&selectMux_);
+        attemptOpen_ = true;   // compte comme l'echec de cette connexion
+        portEXIT_CRITICAL(&selectMux_);
+        recordFailure(ConnectFailure::REJECTED);
+        disconnect();
+    }
 }
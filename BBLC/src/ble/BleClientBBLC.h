@@ -6,7 +6,14 @@
 #include <string>
 #include <vector>
 
-#include "ble/BleStatus.h"   // pour BleState
+#include "ble/AdvStatus.h"
+#include "ble/BleBenchmark.h"
+#include "ble/BleStateMachine.h"
+#include "ble/HeadSelector.h"
+#include "ble/LinkQuality.h"
+#include "ble/ReconnectPolicy.h"
+#include "boot/BootTimeline.h"
+#include "storage/LaunchLog.h"
 
 struct BleAdvertiserInfo {
     NimBLEAddress address;
@@ -17,12 +24,20 @@ struct BleAdvertiserInfo {
     bool hasServiceData;
     bool hasManufacturerData;
 
+    // Statut BBLH lu dans l'annonce (sans connexion)
+    bool hasStatus;
+    AdvStatus status;
+
     uint32_t lastSeenMs;
 };
 
 class BleClientBBLC {
 public:
     using StateCallback = std::function<void(BleState)>;
+    using LaunchLogCallback = std::function<void(const LaunchRecord* records, size_t count, bool last)>;
+    using BootReportCallback = std::function<void(const BootTimeline& head)>;
+    using BenchReportCallback =
+        std::function<void(const BleBench::Report& local, const BleBench::Report& peer)>;
 
     BleClientBBLC();
 
@@ -32,17 +47,66 @@ public:
     void startScan();
     void disconnect();
     bool sendCommand(const uint8_t* data, size_t len, bool response = false);
-    static void onStatusNotify(NimBLERemoteCharacteristic* chr, uint8_t* data, size_t len, bool isNotify);
+
+    // FIRE declenche par un geste : gestureUs = debut du geste (micros())
+    bool sendFire(uint8_t profile, uint8_t strength, uint32_t gestureUs);
+    void onStatusNotify(NimBLERemoteCharacteristic* chr, uint8_t* data, size_t len, bool isNotify);
+    void onLogNotify(const uint8_t* data, size_t len);
 
     BleState getState() const;
 
     void onStateChange(StateCallback cb);
 
+    // ===== Power management =====
+    // Radio ou workflow actif : pas de light sleep (scan, connexion, benchmark)
+    bool isBusy() const;
+    // Intervalle de connexion en ms, 0 si deconnecte
+    uint32_t getConnIntervalMs() const { return connIntervalMs_; }
+    // Delai avant le prochain travail de loop() (UINT32_MAX : rien de prevu)
+    uint32_t msUntilNextWork(uint32_t now) const;
+
+    // Statistiques de la machine d'etats (temps par etat / transition)
+    void logStateStats() const;
+
+    // Tetes vues pendant le scan, avec leur statut annonce
+    const std::vector<BleAdvertiserInfo>& getAdvertisers() const { return seenAdvertisers_; }
+
+    // ===== Link quality / TX power metrics =====
+    LinkQualitySnapshot getLinkQuality() const { return linkMonitor_.snapshot(); }
+    int8_t getTxPowerDbm() const { return txPower_.dbm(); }
+    uint8_t getTxCurrentMa() const { return txPower_.currentMa(); }
+
+    // ===== Throughput benchmark =====
+    bool startBenchmark(const BleBench::Config& config);
+    bool isBenchmarkRunning() const { return bench_.running() || benchAwaitingReport_; }
+    void onBenchmarkReport(BenchReportCallback cb);
+
+    // ===== Launch history export (BBLH flash log) =====
+    bool requestLaunchLog(uint32_t fromSeq = 0);
+    void onLaunchLog(LaunchLogCallback cb);
+
+    // ===== Boot timings de la tete (diagnostic) =====
+    bool requestBootReport();
+    void onBootReport(BootReportCallback cb);
+
 private:
     // ===== Internal helpers =====
-    void setState(BleState newState);
+    bool dispatch(BleEvent event);
+    void drainEvents();
+    void drainStatusFrames();
+    void noteLinkLost();
+    void onTransition(BleState from, BleState to, BleEvent event);
+    void enterScanning();
+    void selectHead();
     void requestConnect(const NimBLEAddress& address);
     void connectIfPending();
+    void recordFailure(ConnectFailure cause);
+    void updateLinkQuality();
+    void updateConnInterval();
+    void resetTxPower();
+    void publishTxPower();
+    void runBenchmark();
+    void abortBenchmark();
 
     // ===== BLE callbacks =====
     class ScanCallbacks : public NimBLEScanCallbacks {
@@ -65,13 +129,26 @@ private:
     // Liste des adresses vues pendant le scan
     std::vector<BleAdvertiserInfo> seenAdvertisers_;
 
-    bool updateAdvertiser(const NimBLEAdvertisedDevice* device);
+    // entry : entree du cache mise a jour (valide jusqu'au prochain ajout)
+    bool updateAdvertiser(const NimBLEAdvertisedDevice* device, const BleAdvertiserInfo** entry);
     bool setupRemoteCharacteristics();
 
 private:
     // ===== State =====
-    BleState state_ = BleState::BOOT;
+    BleStateMachine sm_ {BleRole::CLIENT};
     StateCallback stateCallback_;
+    // Evenements des callbacks NimBLE, dispatches dans loop() : la machine
+    // d'etats n'est touchee que par la tache loop
+    BleEventQueue<8> events_;
+
+    // Trames STATUS lues par loop() (LINK_TX, BENCH_DATA, BENCH_REPORT) :
+    // bench_, benchAwaitingReport_ et peerTxDbm_ restent a la tache loop.
+    // BENCH_DATA n'a que son en-tete copie, len garde la taille recue
+    struct StatusFrame {
+        uint16_t len = 0;
+        uint8_t data[1 + BleBench::REPORT_SIZE] = {};
+    };
+    BleEventQueue<32, StatusFrame> statusFrames_;
 
     // ===== BLE objects =====
     NimBLEClient* client_ = nullptr;
@@ -79,6 +156,7 @@ private:
     NimBLERemoteService* bblhService_ = nullptr;
     NimBLERemoteCharacteristic* chrCmd_ = nullptr;
     NimBLERemoteCharacteristic* chrStatus_ = nullptr;
+    NimBLERemoteCharacteristic* chrLog_ = nullptr;   // optionnel (anciens BBLH)
 
     ScanCallbacks scanCallbacks_;
     ClientCallbacks clientCallbacks_;
@@ -86,4 +164,39 @@ private:
     // ===== Connection workflow =====
     bool pendingConnect_ = false;
     NimBLEAddress targetAddress_;
+
+    // ===== Head selection =====
+    // Nourri par le callback de scan (tache NimBLE), decide dans loop()
+    HeadSelector<NimBLEAddress> selector_;
+    mutable portMUX_TYPE selectMux_ = portMUX_INITIALIZER_UNLOCKED;   // selector_ et reconnect_
+    BleDwellStats selectStats_;
+    bool blockedHeard_ = false;     // tete ecartee par son disjoncteur dans la fenetre
+    uint32_t blockedUntilMs_ = 0;   // reouverture la plus proche de ces disjoncteurs
+
+    // ===== Reconnect policy =====
+    // Backoff + jitter et disjoncteur par tete. Le delai calcule a l'echec
+    // remplace le timeout de DISCONNECTED / ERROR a l'entree de l'etat
+    ReconnectPolicy<NimBLEAddress> reconnect_;
+    uint32_t retryDelayMs_ = 0;
+    bool retryPlanned_ = false;
+    bool attemptOpen_ = false;   // tentative en cours, pas encore comptee
+
+    // ===== Adaptive TX power =====
+    LinkQualityMonitor linkMonitor_;
+    TxPowerController txPower_;
+    int8_t peerTxDbm_ = TX_POWER_LEVELS[TX_POWER_LEVEL_MAX].dbm;
+    uint32_t lastLinkSampleMs_ = 0;
+    uint32_t connIntervalMs_ = 0;
+
+    // ===== Benchmark =====
+    BleBench::Session bench_;
+    bool benchAwaitingReport_ = false;
+    uint32_t benchStopMs_ = 0;
+    BenchReportCallback benchCb_;
+
+    // ===== Launch history =====
+    LaunchLogCallback launchLogCb_;
+
+    // ===== Boot report =====
+    BootReportCallback bootReportCb_;
 };
@@ -1,14 +1,40 @@
 #include <Arduino.h>
 #include "esp_log.h"
+#include "hal/gpio_ll.h"
 #include "ble/BleClientBBLC.h"
 #include "ble/BleStatus.h"
+#include "boot/BootTimeline.h"
+#include "boot/ParallelInit.h"
 #include "led/StatusLed.h"
+#include "motion/ImuLsm6ds3.h"
+#include "motion/RipPipeline.h"
+#include "power/PowerManagerBBLC.h"
 
 static const char* TAG = "MAIN";
+
+// Debug uniquement : attendre un hote serie jusqu'a N ms au boot
+// (ex. -D BBLC_WAIT_SERIAL_MS=3000). Desactive par defaut.
+#ifndef BBLC_WAIT_SERIAL_MS
+#define BBLC_WAIT_SERIAL_MS 0
+#endif
+
 // =========================
 // Hardware
 // =========================
 static constexpr uint8_t STATUS_LED_PIN = 2;
+static constexpr int IMU_SDA_PIN = 6;
+static constexpr int IMU_SCL_PIN = 7;
+static constexpr gpio_num_t IMU_INT1_PIN = GPIO_NUM_3;   // seuil FIFO atteint
+
+// Profil de lancement envoye par le geste "rip"
+static constexpr uint8_t RIP_FIRE_PROFILE = 0;
+
+// =========================
+// Timing
+// =========================
+static constexpr uint32_t HEARTBEAT_PERIOD_MS = 2000;
+static constexpr uint32_t POWER_STATS_PERIOD_MS = 30000;
+static constexpr uint32_t SERIAL_AWAKE_MS = 30000;   // eveille apres une commande serie
 
 // =========================
 // Objects
@@ -16,13 +42,145 @@ static constexpr uint8_t STATUS_LED_PIN = 2;
 StatusLed<STATUS_LED_PIN> statusLed;
 BleStatus<StatusLed<STATUS_LED_PIN>> bleStatus(statusLed);
 BleClientBBLC bleClient;
+PowerManagerBBLC power;
+ImuLsm6ds3 imu(IMU_SDA_PIN, IMU_SCL_PIN);
+RipPipeline<ImuLsm6ds3> rip(imu);
+BootTimeline bootTimeline;
+ParallelInit bleInit;
+
+static void logBootTimeline(const char* who, const BootTimeline& timeline) {
+    char line[256];
+    timeline.format(line, sizeof(line));
+    ESP_LOGI(TAG, "BOOT_BENCH %s %s", who, line);
+}
+
+// INT1 : la FIFO de l'IMU a un lot pret, on reveille loop().
+// Interruption sur niveau haut (le meme type que le reveil GPIO du light
+// sleep) : INT1 reste haut tant que la FIFO n'est pas videe, donc l'ISR
+// se masque elle-meme et loop() la reactive apres rip.poll().
+static volatile uint32_t imuIsrCount = 0;
+static volatile bool imuIrqMasked = false;
+
+static void IRAM_ATTR onImuWatermark() {
+    gpio_ll_intr_disable(&GPIO, IMU_INT1_PIN);
+    imuIrqMasked = true;
+    imuIsrCount = imuIsrCount + 1;
+    power.notifyFromIsr();
+}
+
+static void logRipStats() {
+    if (!rip.ready()) {
+        return;
+    }
+    const RipPipelineStats& st = rip.stats();
+    // Une ISR par seuil FIFO : isr ~ samples / watermark
+    ESP_LOGI(TAG, "Rip: %lu isr, %lu batches, %lu samples (watermark %u), %lu events, %lu overruns, %lu ns/sample, batch avg=%lu max=%lu us",
+             (unsigned long)imuIsrCount, (unsigned long)st.batches, (unsigned long)st.samples,
+             static_cast<unsigned>(imu.watermark()),
+             (unsigned long)st.events, (unsigned long)st.overruns,
+             (unsigned long)st.nsPerSample(),
+             (unsigned long)st.avgBatchUs(), (unsigned long)st.maxBatchUs);
+}
+
+// Geste detecte : tir immediat si une tete est connectee
+static void onRip(const RipEvent& e) {
+    if (bleClient.getState() != BleState::CONNECTED) {
+        ESP_LOGD(TAG, "Rip ignored (not connected), strength=%u", e.strength);
+        return;
+    }
+
+    const bool sent = bleClient.sendFire(RIP_FIRE_PROFILE, e.strength, e.onsetUs);
+    ESP_LOGI(TAG, "Rip -> FIRE %s: strength=%u, onset->detect=%lu us, onset->send=%lu us",
+             sent ? "sent" : "failed", e.strength,
+             (unsigned long)(e.detectedUs - e.onsetUs),
+             (unsigned long)(micros() - e.onsetUs));
+}
+
+// =========================
+// Benchmark sweep ('b' sur le port serie)
+// =========================
+static const BleBench::Config BENCH_SWEEP[] = {
+    // Le MTU est celui du lien (echange une seule fois a la connexion)
+    // direction,                  write type,                      phy, payload, ms
+    {BleBench::Direction::WRITE,  BleBench::WriteType::NO_RESPONSE,   1,  20, 3000},
+    {BleBench::Direction::WRITE,  BleBench::WriteType::NO_RESPONSE,   2, 244, 3000},
+    {BleBench::Direction::WRITE,  BleBench::WriteType::WITH_RESPONSE, 1,  20, 3000},
+    {BleBench::Direction::WRITE,  BleBench::WriteType::WITH_RESPONSE, 2, 244, 3000},
+    {BleBench::Direction::NOTIFY, BleBench::WriteType::NO_RESPONSE,   1,  20, 3000},
+    {BleBench::Direction::NOTIFY, BleBench::WriteType::NO_RESPONSE,   2, 244, 3000},
+};
+static constexpr size_t BENCH_SWEEP_COUNT = sizeof(BENCH_SWEEP) / sizeof(BENCH_SWEEP[0]);
+static size_t benchIndex = BENCH_SWEEP_COUNT;   // == COUNT : pas de sweep en cours
+
+static void runBenchSweep() {
+    if (benchIndex >= BENCH_SWEEP_COUNT || bleClient.isBenchmarkRunning()) {
+        return;
+    }
+
+    if (!bleClient.startBenchmark(BENCH_SWEEP[benchIndex])) {
+        ESP_LOGW(TAG, "Benchmark sweep aborted");
+        benchIndex = BENCH_SWEEP_COUNT;
+        return;
+    }
+    ++benchIndex;
+}
+
+// =========================
+// Commandes serie (debug)
+//   b : sweep benchmark
+//   l : export de l'historique des lancers BBLH
+//   t : temps de boot (BBLC + tete connectee)
+//   m : statistiques du detecteur de geste
+// =========================
+static uint32_t lastSerialCmdMs = 0;
+static bool serialCmdSeen = false;
+
+static void handleSerialCommands() {
+    if (!Serial.available()) {
+        return;
+    }
+
+    lastSerialCmdMs = millis();
+    serialCmdSeen = true;
+
+    switch (Serial.read()) {
+        case 'b':
+            ESP_LOGI(TAG, "Benchmark sweep requested");
+            benchIndex = 0;
+            break;
+
+        case 'l':
+            ESP_LOGI(TAG, "Launch log export requested");
+            bleClient.requestLaunchLog();
+            break;
+
+        case 't':
+            logBootTimeline("BBLC", bootTimeline);
+            bleClient.requestBootReport();
+            break;
+
+        case 'm':
+            logRipStats();
+            break;
+
+        default:
+            break;
+    }
+}
 
 // =========================
 // Setup
 // =========================
 void setup() {
+    bootTimeline.mark(BootMilestone::SETUP_ENTRY, micros());
+
     Serial.begin(115200);
-    delay(1000);
+#if BBLC_WAIT_SERIAL_MS > 0
+    while (!Serial && millis() < BBLC_WAIT_SERIAL_MS) {
+        delay(10);
+    }
+#endif
+    bootTimeline.mark(BootMilestone::SERIAL_READY, micros());
 
     esp_log_level_set("NimBLE", ESP_LOG_DEBUG);
     esp_log_level_set("ble_gap", ESP_LOG_DEBUG);
@@ -30,37 +188,132 @@ void setup() {
 
     ESP_LOGI(TAG, "BBLC BLE Client started");
 
-    // Init LED
+    // Light sleep entre les evenements BLE (remplace le delay(10) de loop).
+    // Avant l'init BLE : le controleur prend ses verrous PM au demarrage.
+    power.begin();
+
+    // Transitions BLE. Peut tourner dans la tache ble_init pendant que
+    // setup() demarre la LED : la LED suit l'etat depuis loop() (syncStatusLed)
+    bleClient.onStateChange([](BleState state) {
+        ESP_LOGI(TAG, "BLE state -> %s (%d)", bleStateToString(state), static_cast<int>(state));
+        if (state == BleState::SCANNING)  bootTimeline.mark(BootMilestone::SCANNING, micros());
+        if (state == BleState::CONNECTED) bootTimeline.mark(BootMilestone::CONNECTED, micros());
+    });
+
+    // Temps de boot de la tete, demande avec 't'
+    bleClient.onBootReport([](const BootTimeline& head) {
+        logBootTimeline("BBLH", head);
+    });
+
+    // Historique des lancers exporte par BBLH
+    bleClient.onLaunchLog([](const LaunchRecord* records, size_t count, bool last) {
+        static uint32_t received = 0;
+        for (size_t i = 0; i < count; ++i) {
+            ESP_LOGD(TAG, "Launch #%lu boot=%u t=%lu ms profile=%u rpm=%u latency=%lu us",
+                     (unsigned long)records[i].seq, records[i].bootCount,
+                     (unsigned long)records[i].timestampMs, records[i].profile,
+                     records[i].rpm, (unsigned long)records[i].latencyUs);
+        }
+        received += count;
+        if (last) {
+            ESP_LOGI(TAG, "Launch log received: %lu records", (unsigned long)received);
+            received = 0;
+        }
+    });
+
+    // Pile BLE + scan dans leur propre tache pendant l'init de la LED
+    bleInit.start("ble_init", [] {
+        bleClient.begin();
+        bootTimeline.mark(BootMilestone::BLE_READY, micros());
+        bleClient.startScan();
+    });
+
     statusLed.begin();
+    bootTimeline.mark(BootMilestone::LED_READY, micros());
+
+    // IMU : lue par lots sur interruption, INT1 reveille aussi du light sleep
+    if (rip.begin()) {
+        pinMode(IMU_INT1_PIN, INPUT);
+        power.addWakePin(IMU_INT1_PIN, true);   // passe la broche en niveau haut
+        attachInterrupt(IMU_INT1_PIN, onImuWatermark, ONHIGH);
+    } else {
+        ESP_LOGW(TAG, "No IMU, rip gesture disabled");
+    }
 
-    // Init BLE client
-    bleClient.begin();
+    bleInit.wait();
 
-    // Bind BLE state → LED
-    bleClient.onStateChange([](BleState state) {
-        ESP_LOGI(TAG, "BLE state -> %s (%d)", bleStateToString(state), state);
+    bootTimeline.mark(BootMilestone::SETUP_DONE, micros());
+    logBootTimeline("BBLC", bootTimeline);
+}
+
+// Etat BLE -> LED, uniquement depuis loop() : seule tache qui touche la LED
+static void syncStatusLed() {
+    static BleState shown = BleState::COUNT;
+    const BleState state = bleClient.getState();
+    if (state != shown) {
+        shown = state;
         bleStatus.update(state);
-    });
+    }
+}
 
-    // Start scanning explicitly
-    bleClient.startScan();
+// Une echeance relative pour une periode demarree a `since`
+static uint32_t msUntil(uint32_t now, uint32_t since, uint32_t period) {
+    const uint32_t elapsed = now - since;
+    return elapsed >= period ? 0 : period - elapsed;
 }
 
 // =========================
 // Loop
 // =========================
 void loop() {
+    // Mise sous tension -> premiere connexion, une seule fois
+    static bool connectReported = false;
+    if (!connectReported && bootTimeline.reached(BootMilestone::CONNECTED)) {
+        connectReported = true;
+        logBootTimeline("BBLC", bootTimeline);
+    }
+
+    rip.poll(onRip);   // en premier : c'est le chemin du tir
+    if (imuIrqMasked) {
+        // FIFO videe : INT1 est retombe, sinon l'ISR repart aussitot
+        imuIrqMasked = false;
+        gpio_intr_enable(IMU_INT1_PIN);
+    }
     bleClient.loop();
+    handleSerialCommands();
+    runBenchSweep();
+    syncStatusLed();
     statusLed.update();   // ✅ indispensable pour les animations (SCANNING, CONNECTING…)
 
     // Optionnel : heartbeat pour vérifier que le loop tourne
     static uint32_t lastBeat = 0;
-    if (millis() - lastBeat > 2000) {
+    if (millis() - lastBeat >= HEARTBEAT_PERIOD_MS) {
         lastBeat = millis();
         BleState state = bleClient.getState();
         ESP_LOGD(TAG, "BLE current state = %s", bleStateToString(state));
+        ESP_LOGD(TAG, "TX power = %d dBm (~%u mA)",
+                 bleClient.getTxPowerDbm(), bleClient.getTxCurrentMa());
+    }
+
+    static uint32_t lastPowerStats = 0;
+    if (millis() - lastPowerStats >= POWER_STATS_PERIOD_MS) {
+        lastPowerStats = millis();
+        power.logStats();
+        bleClient.logStateStats();
+        logRipStats();
     }
 
+    // Prochaine echeance reelle, puis sommeil jusque-la
+    const uint32_t now = millis();
+    power.addDeadline(statusLed.msUntilNextFrame(now));
+    power.addDeadline(bleClient.msUntilNextWork(now));
+    power.addDeadline(msUntil(now, lastBeat, HEARTBEAT_PERIOD_MS));
+    power.addDeadline(msUntil(now, lastPowerStats, POWER_STATS_PERIOD_MS));
 
-    delay(10);
+    // Session serie : eveille un moment apres la derniere commande, pas tant
+    // que l'USB est branche (sinon la carte ne dort jamais sur secteur USB)
+    const bool serialSession = serialCmdSeen && now - lastSerialCmdMs < SERIAL_AWAKE_MS;
+    power.setBusy(bleClient.isBusy() || benchIndex < BENCH_SWEEP_COUNT || serialSession);
+    power.setArmed(bleClient.getState() == BleState::CONNECTED);
+    power.sleep(bleClient.getConnIntervalMs());
 }
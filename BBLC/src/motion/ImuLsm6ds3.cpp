@@ -0,0 +1,167 @@
+#include "ImuLsm6ds3.h"
+#include "esp_log.h"
+
+static const char* TAG = "IMU";
+
+// ==========================
+// Registres (LSM6DS3 / LSM6DS3TR-C)
+// ==========================
+static constexpr uint8_t REG_FIFO_CTRL1 = 0x06;   // seuil FIFO [7:0], en mots de 16 bits
+static constexpr uint8_t REG_FIFO_CTRL2 = 0x07;   // seuil FIFO [11:8]
+static constexpr uint8_t REG_FIFO_CTRL3 = 0x08;   // decimation gyro / accel
+static constexpr uint8_t REG_FIFO_CTRL5 = 0x0A;   // ODR FIFO + mode
+static constexpr uint8_t REG_INT1_CTRL  = 0x0D;
+static constexpr uint8_t REG_WHO_AM_I   = 0x0F;
+static constexpr uint8_t REG_CTRL1_XL   = 0x10;
+static constexpr uint8_t REG_CTRL2_G    = 0x11;
+static constexpr uint8_t REG_CTRL3_C    = 0x12;
+static constexpr uint8_t REG_FIFO_STATUS1 = 0x3A;   // 0x3A..0x3D lus d'un bloc
+static constexpr uint8_t REG_FIFO_DATA_OUT_L = 0x3E;
+
+static constexpr uint8_t WHO_AM_I_DS3 = 0x69;
+static constexpr uint8_t WHO_AM_I_DS3TRC = 0x6A;
+
+static constexpr uint8_t CTRL3_SW_RESET = 0x01;
+static constexpr uint8_t CTRL3_BDU_IF_INC = 0x44;
+static constexpr uint8_t CTRL1_XL_1K66_16G = 0x84;
+static constexpr uint8_t CTRL2_G_1K66_2000DPS = 0x8C;
+static constexpr uint8_t FIFO_CTRL3_NO_DECIMATION = 0x09;   // gyro et accel dans la FIFO
+static constexpr uint8_t FIFO_CTRL5_1K66_CONTINUOUS = 0x46;
+static constexpr uint8_t INT1_FIFO_THRESHOLD = 0x08;
+
+static constexpr uint8_t FIFO_STATUS2_OVERRUN = 0x40;
+
+// Un echantillon = gyro XYZ puis accel XYZ
+static constexpr size_t WORDS_PER_SAMPLE = 6;
+static constexpr size_t BYTES_PER_SAMPLE = WORDS_PER_SAMPLE * 2;
+
+// Rafale I2C : le buffer Wire de l'ESP32 fait 128 octets
+static constexpr size_t BURST_SAMPLES = 10;
+
+static constexpr uint32_t I2C_CLOCK_HZ = 400000;
+
+// ==========================
+// Public API
+// ==========================
+bool ImuLsm6ds3::begin() {
+    wire_.begin(sdaPin_, sclPin_, I2C_CLOCK_HZ);
+
+    uint8_t id = 0;
+    if (!readRegs(REG_WHO_AM_I, &id, 1) || (id != WHO_AM_I_DS3 && id != WHO_AM_I_DS3TRC)) {
+        ESP_LOGE(TAG, "LSM6DS3 not found at 0x%02X (id=0x%02X)", address_, id);
+        return false;
+    }
+
+    writeReg(REG_CTRL3_C, CTRL3_SW_RESET);
+    for (int i = 0; i < 10; ++i) {
+        uint8_t ctrl3 = CTRL3_SW_RESET;
+        delay(1);
+        if (readRegs(REG_CTRL3_C, &ctrl3, 1) && !(ctrl3 & CTRL3_SW_RESET)) break;
+    }
+
+    const uint16_t thresholdWords = static_cast<uint16_t>(watermark_ * WORDS_PER_SAMPLE);
+    const bool ok =
+        writeReg(REG_CTRL3_C, CTRL3_BDU_IF_INC) &&
+        writeReg(REG_FIFO_CTRL5, 0x00) &&   // bypass : vide la FIFO
+        writeReg(REG_FIFO_CTRL1, thresholdWords & 0xFF) &&
+        writeReg(REG_FIFO_CTRL2, (thresholdWords >> 8) & 0x0F) &&
+        writeReg(REG_FIFO_CTRL3, FIFO_CTRL3_NO_DECIMATION) &&
+        writeReg(REG_INT1_CTRL, INT1_FIFO_THRESHOLD) &&
+        writeReg(REG_CTRL1_XL, CTRL1_XL_1K66_16G) &&
+        writeReg(REG_CTRL2_G, CTRL2_G_1K66_2000DPS) &&
+        writeReg(REG_FIFO_CTRL5, FIFO_CTRL5_1K66_CONTINUOUS);
+
+    if (!ok) {
+        ESP_LOGE(TAG, "LSM6DS3 configuration failed");
+        return false;
+    }
+
+    skipWords_ = 0;
+    overrun_ = false;
+    ESP_LOGI(TAG, "LSM6DS3 ready (id=0x%02X, 1.66 kHz FIFO, watermark %u samples)",
+             id, static_cast<unsigned>(watermark_));
+    return true;
+}
+
+size_t ImuLsm6ds3::available() {
+    uint8_t status[4];
+    if (!readRegs(REG_FIFO_STATUS1, status, sizeof(status))) {
+        return 0;
+    }
+
+    if (status[1] & FIFO_STATUS2_OVERRUN) {
+        overrun_ = true;
+    }
+
+    const uint16_t words = static_cast<uint16_t>(status[0] | ((status[1] & 0x0F) << 8));
+    const uint16_t pattern = static_cast<uint16_t>(status[2] | ((status[3] & 0x03) << 8));
+
+    // Prochain mot pas sur le gyro X (overrun, lecture interrompue) : on se realigne
+    skipWords_ = pattern % WORDS_PER_SAMPLE
+        ? static_cast<uint16_t>(WORDS_PER_SAMPLE - pattern % WORDS_PER_SAMPLE)
+        : 0;
+
+    return words > skipWords_ ? (words - skipWords_) / WORDS_PER_SAMPLE : 0;
+}
+
+size_t ImuLsm6ds3::readFifo(ImuSample* out, size_t maxCount) {
+    uint8_t raw[BURST_SAMPLES * BYTES_PER_SAMPLE];
+
+    if (skipWords_) {
+        if (!readRegs(REG_FIFO_DATA_OUT_L, raw, skipWords_ * 2)) return 0;
+        skipWords_ = 0;
+    }
+
+    size_t done = 0;
+    while (done < maxCount) {
+        const size_t n = (maxCount - done) < BURST_SAMPLES ? (maxCount - done) : BURST_SAMPLES;
+
+        // L'adresse reboucle sur FIFO_DATA_OUT_L : une seule transaction par rafale
+        if (!readRegs(REG_FIFO_DATA_OUT_L, raw, n * BYTES_PER_SAMPLE)) break;
+
+        for (size_t i = 0; i < n; ++i) {
+            const uint8_t* p = raw + i * BYTES_PER_SAMPLE;
+            ImuSample& s = out[done + i];
+            s.gx = static_cast<int16_t>(p[0] | (p[1] << 8));
+            s.gy = static_cast<int16_t>(p[2] | (p[3] << 8));
+            s.gz = static_cast<int16_t>(p[4] | (p[5] << 8));
+            s.ax = static_cast<int16_t>(p[6] | (p[7] << 8));
+            s.ay = static_cast<int16_t>(p[8] | (p[9] << 8));
+            s.az = static_cast<int16_t>(p[10] | (p[11] << 8));
+        }
+        done += n;
+    }
+    return done;
+}
+
+bool ImuLsm6ds3::overrun() {
+    const bool lost = overrun_;
+    overrun_ = false;
+    return lost;
+}
+
+// ==========================
+// Internal logic
+// ==========================
+bool ImuLsm6ds3::writeReg(uint8_t reg, uint8_t value) {
+    wire_.beginTransmission(address_);
+    wire_.write(reg);
+    wire_.write(value);
+    return wire_.endTransmission() == 0;
+}
+
+bool ImuLsm6ds3::readRegs(uint8_t reg, uint8_t* out, size_t len) {
+    wire_.beginTransmission(address_);
+    wire_.write(reg);
+    if (wire_.endTransmission(false) != 0) {
+        return false;
+    }
+
+    if (wire_.requestFrom(address_, len) != len) {
+        return false;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        out[i] = static_cast<uint8_t>(wire_.read());
+    }
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "motion/RipDetector.h"
+
+// =======================================================
+// Centrale inertielle LSM6DS3 / LSM6DS3TR-C en I2C, FIFO uniquement
+//
+// Accel +-16 g et gyro +-2000 dps a 1.66 kHz, empiles dans la FIFO
+// du capteur (mode continu). INT1 monte quand la FIFO atteint le
+// seuil : on lit alors tout en rafales, sans jamais interroger le
+// capteur echantillon par echantillon.
+//
+// Forme attendue par RipPipeline (voir motion/RipPipeline.h).
+// =======================================================
+class ImuLsm6ds3 {
+public:
+    static constexpr uint8_t DEFAULT_ADDRESS = 0x6A;   // SDO/SA0 a GND : 0x6A, a VDD : 0x6B
+    static constexpr uint32_t SAMPLE_PERIOD_US = 600;  // 1.66 kHz
+
+    ImuLsm6ds3(int sdaPin, int sclPin, uint16_t watermarkSamples = 16,
+               uint8_t address = DEFAULT_ADDRESS, TwoWire& wire = Wire)
+        : wire_(wire), sdaPin_(sdaPin), sclPin_(sclPin),
+          address_(address), watermark_(watermarkSamples) {}
+
+    bool begin();
+
+    uint32_t samplePeriodUs() const { return SAMPLE_PERIOD_US; }
+    uint16_t watermark() const { return watermark_; }
+
+    // Echantillons complets (gyro + accel) dans la FIFO
+    size_t available();
+
+    // Lecture en rafale, du plus ancien au plus recent
+    size_t readFifo(ImuSample* out, size_t maxCount);
+
+    // FIFO pleine depuis le dernier appel : des echantillons ont ete perdus
+    bool overrun();
+
+    uint32_t nowUs() const { return micros(); }
+
+private:
+    bool writeReg(uint8_t reg, uint8_t value);
+    bool readRegs(uint8_t reg, uint8_t* out, size_t len);
+
+    TwoWire& wire_;
+    int sdaPin_;
+    int sclPin_;
+    uint8_t address_;
+    uint16_t watermark_;
+
+    uint16_t skipWords_ = 0;   // mots a jeter pour se realigner sur le gyro X
+    bool overrun_ = false;
+};
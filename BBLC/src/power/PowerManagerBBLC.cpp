@@ -0,0 +1,124 @@
+#include "PowerManagerBBLC.h"
+#include "esp_log.h"
+
+#include <esp_idf_version.h>
+#include <esp_sleep.h>
+
+static const char* TAG = "POWER";
+
+// Frequences CPU sous esp_pm (ESP32-C3)
+static constexpr int CPU_MAX_FREQ_MHZ = 160;
+static constexpr int CPU_MIN_FREQ_MHZ = 40;
+
+// ==========================
+// Public API
+// ==========================
+void PowerManagerBBLC::begin(const PowerConfig& config) {
+    PowerConfig effective = config;
+    loopTask_ = xTaskGetCurrentTaskHandle();
+
+#if CONFIG_PM_ENABLE
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    esp_pm_config_t pm = {};
+#else
+    esp_pm_config_esp32c3_t pm = {};
+#endif
+    pm.max_freq_mhz = CPU_MAX_FREQ_MHZ;
+    pm.min_freq_mhz = CPU_MIN_FREQ_MHZ;
+    pm.light_sleep_enable = effective.lightSleepEnabled;
+
+    // Echoue si le sdkconfig n'a pas le tickless idle : on garde alors
+    // le DFS seul et le scheduler ne propose plus de LIGHT_SLEEP.
+    esp_err_t err = esp_pm_configure(&pm);
+    if (err != ESP_OK && pm.light_sleep_enable) {
+        pm.light_sleep_enable = false;
+        err = esp_pm_configure(&pm);
+    }
+    lightSleepAvailable_ = (err == ESP_OK) && pm.light_sleep_enable;
+
+    if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "bblc_awake", &noSleepLock_) != ESP_OK) {
+        noSleepLock_ = nullptr;
+        lightSleepAvailable_ = false;
+    }
+#else
+    // sdkconfig Arduino par defaut : ni esp_pm ni tickless idle
+    ESP_LOGW(TAG, "CONFIG_PM_ENABLE off in this build (use env bb_lc_sleep)");
+    lightSleepAvailable_ = false;
+#endif
+
+    if (!lightSleepAvailable_) {
+        ESP_LOGW(TAG, "Light sleep unavailable in this build, idle only");
+        effective.lightSleepEnabled = false;
+    }
+
+    scheduler_.configure(effective);
+    scheduler_.beginCycle();
+    energy_.reset();
+
+    holdAwake(true);
+    lastWakeMs_ = millis();
+
+    ESP_LOGI(TAG, "Power manager ready (light sleep %s, armed latency %lu ms)",
+             lightSleepAvailable_ ? "on" : "off",
+             static_cast<unsigned long>(effective.armedLatencyMs));
+}
+
+void PowerManagerBBLC::addWakePin(gpio_num_t pin, bool activeHigh) {
+    gpio_wakeup_enable(pin, activeHigh ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+}
+
+void IRAM_ATTR PowerManagerBBLC::notifyFromIsr() {
+    if (!loopTask_) {
+        return;
+    }
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(loopTask_, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void PowerManagerBBLC::sleep(uint32_t bleIntervalMs) {
+    // Temps passe a travailler depuis le dernier reveil
+    const uint32_t start = millis();
+    energy_.account(PowerState::ACTIVE, start - lastWakeMs_, lastBleIntervalMs_);
+
+    lastDecision_ = scheduler_.decide(busy_, armed_, bleIntervalMs);
+    holdAwake(lastDecision_.state != PowerState::LIGHT_SLEEP);
+
+    // Attente interruptible : une ISR d'entree (notifyFromIsr) reveille loop() tout de suite
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(lastDecision_.sleepMs));
+
+    lastWakeMs_ = millis();
+    energy_.account(lastDecision_.state, lastWakeMs_ - start, bleIntervalMs);
+    lastBleIntervalMs_ = bleIntervalMs;
+
+    // Retour a la pleine reactivite pour le tour de loop()
+    holdAwake(true);
+    scheduler_.beginCycle();
+}
+
+void PowerManagerBBLC::logStats() const {
+    ESP_LOGI(TAG, "Power: active=%lu idle=%lu sleep=%lu permille, avg ~%lu uA, %lu uAh, %lu BLE events",
+             static_cast<unsigned long>(energy_.permille(PowerState::ACTIVE)),
+             static_cast<unsigned long>(energy_.permille(PowerState::IDLE)),
+             static_cast<unsigned long>(energy_.permille(PowerState::LIGHT_SLEEP)),
+             static_cast<unsigned long>(energy_.averageUa()),
+             static_cast<unsigned long>(energy_.chargeUah()),
+             static_cast<unsigned long>(energy_.bleEvents()));
+}
+
+// ==========================
+// Internal logic
+// ==========================
+void PowerManagerBBLC::holdAwake(bool hold) {
+    if (!noSleepLock_ || hold == lockHeld_) {
+        return;
+    }
+
+    if (hold) {
+        esp_pm_lock_acquire(noSleepLock_);
+    } else {
+        esp_pm_lock_release(noSleepLock_);
+    }
+    lockHeld_ = hold;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <esp_pm.h>
+
+#include "power/PowerScheduler.h"
+
+// =======================================================
+// Gestion d'energie BBLC
+//
+// Remplace le delay(10) de loop() : la tache loop dort jusqu'a la
+// prochaine echeance reelle (frame LED, echantillon de lien...) et
+// le tickless idle de FreeRTOS passe en light sleep pendant ce temps,
+// le controleur BLE restant en modem sleep entre deux evenements de
+// connexion.
+//
+// Un verrou NO_LIGHT_SLEEP est tenu tant que la decision n'est pas
+// LIGHT_SLEEP (scan, connexion, benchmark, commande serie recente...).
+//
+// Le light sleep demande CONFIG_PM_ENABLE et le tickless idle, absents
+// du sdkconfig Arduino : seul l'env bb_lc_sleep les active. Avec bb_lc,
+// begin() le signale et loop() ne fait qu'attendre (IDLE).
+// =======================================================
+class PowerManagerBBLC {
+public:
+    void begin(const PowerConfig& config = PowerConfig());
+
+    // Broche qui reveille la puce (bouton, data-ready IMU...).
+    // Le reveil GPIO impose une interruption sur niveau : le type de la
+    // broche est ecrase, une ISR attachee doit etre sur ONHIGH / ONLOW
+    // et se masquer jusqu'a ce que la source retombe.
+    void addWakePin(gpio_num_t pin, bool activeHigh);
+
+    // Appelable depuis une ISR : termine l'attente en cours de sleep().
+    void notifyFromIsr();
+
+    void setBusy(bool busy) { busy_ = busy; }
+    void setArmed(bool armed) { armed_ = armed; }
+
+    // A appeler a chaque tour de loop(), avant sleep()
+    void addDeadline(uint32_t inMs) { scheduler_.addDeadline(inMs); }
+
+    // Dort jusqu'a la prochaine echeance puis prepare le tour suivant.
+    // bleIntervalMs : intervalle de connexion courant, 0 si deconnecte.
+    void sleep(uint32_t bleIntervalMs);
+
+    bool lightSleepAvailable() const { return lightSleepAvailable_; }
+    PowerState lastState() const { return lastDecision_.state; }
+    const EnergyModel& energy() const { return energy_; }
+
+    void logStats() const;
+
+private:
+    void holdAwake(bool hold);
+
+    PowerScheduler scheduler_;
+    EnergyModel energy_;
+    PowerDecision lastDecision_;
+
+    bool busy_ = true;
+    bool armed_ = false;
+    bool lightSleepAvailable_ = false;
+
+    esp_pm_lock_handle_t noSleepLock_ = nullptr;
+    bool lockHeld_ = false;
+
+    TaskHandle_t loopTask_ = nullptr;
+    uint32_t lastWakeMs_ = 0;
+    uint32_t lastBleIntervalMs_ = 0;
+};
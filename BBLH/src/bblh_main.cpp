@@ -1,9 +1,19 @@
 #include <Arduino.h>
 #include "esp_log.h"
 
+#include "ble/BleProtocol.h"
 #include "ble/BleServerBBLH.h"
 #include "ble/BleStatus.h"
+#include "boot/BootTimeline.h"
+#include "boot/ParallelInit.h"
 #include "led/StatusLed.h"
+#include "storage/LaunchHistory.h"
+
+// Debug only: wait up to N ms for a serial host before booting
+// (e.g. -D BBLH_WAIT_SERIAL_MS=3000). Off by default, heads must boot fast.
+#ifndef BBLH_WAIT_SERIAL_MS
+#define BBLH_WAIT_SERIAL_MS 0
+#endif
 
 // GPIO réel
 static constexpr uint8_t STATUS_LED_PIN = 2;
@@ -14,9 +24,64 @@ StatusLed<STATUS_LED_PIN> statusLed;
 BleStatus<StatusLed<STATUS_LED_PIN>> bleStatus(statusLed);
 BleServerBBLH bleServer;
 
+EspPartitionFlash launchFlash;
+LaunchHistory launchLog(launchFlash);
+
+BootTimeline bootTimeline;
+ParallelInit bleInit;
+
+static void logBootTimeline() {
+    char line[256];
+    bootTimeline.format(line, sizeof(line));
+    ESP_LOGI(TAG, "BOOT_BENCH BBLH %s", line);
+}
+
+// Launches are captured in the BLE callback and written to flash from
+// loop(), so the log is only ever touched by one task.
+static BleEventQueue<8, LaunchRecord> pendingLaunches;
+
+// latencyUs and rpm stay 0 (unknown) until the launcher output and the
+// RPM sensor are wired: there is no fire edge to stamp yet.
+static void recordLaunch(uint8_t profile, uint8_t flags) {
+    LaunchRecord record {};
+    record.timestampMs = millis();
+    record.profile = profile;
+    record.flags = flags;
+    if (!pendingLaunches.post(record)) {
+        ESP_LOGW(TAG, "Launch log queue full, record dropped");
+    }
+}
+
+static void flushLaunches() {
+    LaunchRecord record;
+    while (pendingLaunches.pop(record)) {
+        const uint32_t t0 = micros();
+        const bool ok = launchLog.append(record);
+        ESP_LOGD(TAG, "Launch #%lu logged (%s, %lu us)",
+            (unsigned long)record.seq, ok ? "ok" : "fail", (unsigned long)(micros() - t0));
+    }
+}
+
+// BLE state -> LED, from loop() only: the one task that drives the LED
+static void syncStatusLed() {
+    static BleState shown = BleState::COUNT;
+    const BleState state = bleServer.getState();
+    if (state != shown) {
+        shown = state;
+        bleStatus.update(state);
+    }
+}
+
 void setup() {
+    bootTimeline.mark(BootMilestone::SETUP_ENTRY, micros());
+
     Serial.begin(115200);
-    delay(200);
+#if BBLH_WAIT_SERIAL_MS > 0
+    while (!Serial && millis() < BBLH_WAIT_SERIAL_MS) {
+        delay(10);
+    }
+#endif
+    bootTimeline.mark(BootMilestone::SERIAL_READY, micros());
 
     esp_log_level_set("NimBLE", ESP_LOG_DEBUG);
     esp_log_level_set("ble_gap", ESP_LOG_DEBUG);
@@ -24,11 +89,12 @@ void setup() {
 
     ESP_LOGI(TAG, "BBLH server starting");
 
-    statusLed.begin();
-
+    // The first transitions run in the ble_init task while setup() brings
+    // the LED up: the LED follows the state from loop() (syncStatusLed)
     bleServer.onStateChange([](BleState s) {
         ESP_LOGI(TAG, "BLE state -> %s (%d)", bleStateToString(s), (int)s);
-        bleStatus.update(s);
+        if (s == BleState::ADVERTISING) bootTimeline.mark(BootMilestone::ADVERTISING, micros());
+        if (s == BleState::CONNECTED)   bootTimeline.mark(BootMilestone::CONNECTED, micros());
     });
 
     bleServer.onCommand([](const uint8_t* data, size_t len) {
@@ -36,15 +102,62 @@ void setup() {
         ESP_LOGI(TAG, "APP command received (%u bytes)", (unsigned)len);
 
         // Ici tu branches ta logique de launcher.
-        // Exemple: si data[0] == 0x01 => fire
+        if (len >= 1 && data[0] == static_cast<uint8_t>(BleProto::Op::FIRE)) {
+            // fire();
+            if (len >= BleProto::FIRE_GESTURE_FRAME_LEN) {
+                const uint32_t ageUs = BleProto::getU32(data + 3);
+                ESP_LOGI(TAG, "FIRE by gesture: strength=%u age=%lu us", data[2], (unsigned long)ageUs);
+                recordLaunch(data[1], LAUNCH_FLAG_GESTURE);
+            } else {
+                recordLaunch(len >= BleProto::FIRE_FRAME_LEN ? data[1] : 0, 0);
+            }
+        }
+    });
+
+    // BLE stack, GATT and advertising come up in their own task while
+    // the LED and the launch log are initialised here.
+    bleServer.attachBootTimeline(bootTimeline);
+    bleInit.start("ble_init", [] {
+        bleServer.begin();
+        bootTimeline.mark(BootMilestone::BLE_READY, micros());
     });
 
-    bleServer.begin();
-    bleStatus.update(bleServer.getState());
+    statusLed.begin();
+    bootTimeline.mark(BootMilestone::LED_READY, micros());
+
+    // Launch history: recovery scans the partition once
+    const uint32_t recoveryStart = micros();
+    if (launchFlash.begin(LAUNCH_LOG_PARTITION) && launchLog.begin()) {
+        bootTimeline.mark(BootMilestone::STORAGE_READY, micros());
+        bleServer.attachLaunchLog(launchLog);
+        ESP_LOGI(TAG, "Launch log ready: next=%lu boot=%u capacity=%u (%lu us)",
+            (unsigned long)launchLog.nextSeq(),
+            (unsigned)launchLog.bootCount(),
+            (unsigned)launchLog.capacity(),
+            (unsigned long)(micros() - recoveryStart));
+    } else {
+        ESP_LOGE(TAG, "Launch log partition '%s' unavailable", LAUNCH_LOG_PARTITION);
+    }
+
+    bleInit.wait();
+    bleServer.setHeadStatus(true, false);   // ready, not armed (no battery gauge yet)
+
+    bootTimeline.mark(BootMilestone::SETUP_DONE, micros());
+    logBootTimeline();
 }
 
 void loop() {
+    // Power-on to first client, reported once
+    static bool connectReported = false;
+    if (!connectReported && bootTimeline.reached(BootMilestone::CONNECTED)) {
+        connectReported = true;
+        logBootTimeline();
+    }
+
     bleServer.loop();
+    flushLaunches();
+    launchLog.maintain();   // pre-erase the next log sector off the launch path
+    syncStatusLed();
     statusLed.update();   // moteur LED (comme ton test_led_RGB.cpp)
 
     // Debug périodique
@@ -55,5 +168,8 @@ void loop() {
          "BLE current state = %s (server=%s)",
          bleStateToString(bleServer.getState()),
          bleServer.getServerAddress().toString().c_str());
+        bleServer.logPeerStats();
+        bleServer.logOutboundStats();
+        bleServer.logStateStats();
     }
 }
@@ -1,41 +1,80 @@
 #include "ble/BleServerBBLH.h"
 #include "esp_log.h"
 
+#include "ble/BblhGattNimBLE.h"
+#include "ble/BleProtocol.h"
+#include "ble/BleTxPower.h"
+
+#if defined(CONFIG_NIMBLE_CPP_IDF)
+#include "os/os_mbuf.h"
+#else
+#include "nimble/porting/nimble/include/os/os_mbuf.h"
+#endif
+
+#ifndef BBLH_FW_VERSION_MAJOR
+#define BBLH_FW_VERSION_MAJOR 0
+#endif
+#ifndef BBLH_FW_VERSION_MINOR
+#define BBLH_FW_VERSION_MINOR 0
+#endif
+
 // TAGs (same spirit as BBLC)
 static const char* TAG = "BBLH_BLE";
 
-// UUIDs (keep identical to BBLC)
-static const NimBLEUUID UUID_BBLH_SERVICE(
-    "a1b2c3d4-0001-4000-8000-000000000001"
-);
+// RSSI / link quality sampling period
+static constexpr uint32_t LINK_SAMPLE_PERIOD_MS = 500;
+
+// Benchmark: max burst length per loop() and safety stop if BBLC goes silent
+static constexpr uint32_t BENCH_SLICE_MS = 20;
+static constexpr uint32_t BENCH_STOP_GRACE_MS = 5000;
+
+// Host buffers (msys mbufs) the low priority traffic leaves free, so
+// acks and fault reports still go out while telemetry, the log export
+// or the benchmark saturate the links
+static constexpr int NOTIFY_MBUF_RESERVE = 4;
 
-static const NimBLEUUID UUID_BBLH_CMD(
-    "a1b2c3d4-0002-4000-8000-000000000001"
-);
+// Coalescing key for the text status (binary frames use their opcode)
+static constexpr uint8_t KEY_STATUS_TEXT = 0xFF;
 
-static const NimBLEUUID UUID_BBLH_STATUS(
-    "a1b2c3d4-0003-4000-8000-000000000001"
-);
+// Launch history export: time budget per loop() and largest batch buffer
+static constexpr uint32_t LOG_EXPORT_SLICE_MS = 10;
+static constexpr size_t LOG_FRAME_MAX = BLE_ATT_ATTR_MAX_LEN;
 
 BleServerBBLH::BleServerBBLH()
     : serverCallbacks_(*this),
-      cmdCallbacks_(*this) {}
+      cmdCallbacks_(*this),
+      statusCallbacks_(*this) {}
 
 void BleServerBBLH::begin() {
     NimBLEDevice::init("BBLH");
-    NimBLEDevice::setPower(ESP_PWR_LVL_P9);
+    resetTxPower();
+
+    sm_.onTransition([this](BleState from, BleState to, BleEvent event) {
+        onTransition(from, to, event);
+    });
+    sm_.begin(millis());
 
     server_ = NimBLEDevice::createServer();
     server_->setCallbacks(&serverCallbacks_);
+    server_->advertiseOnDisconnect(false);   // handled in onDisconnect (slot aware)
 
     serverAddress_ = NimBLEDevice::getAddress();
 
+    advStatus_.fwMajor = BBLH_FW_VERSION_MAJOR;
+    advStatus_.fwMinor = BBLH_FW_VERSION_MINOR;
+
     setupGatt();
+    refreshAdvStatus();
     startAdvertising();
 }
 
 void BleServerBBLH::loop() {
-    // Symmetry with BBLC. Nothing to run here for NimBLE server for now.
+    drainEvents();        // link up / lost seen by the host task
+    sm_.poll(millis());   // DISCONNECTED / ERROR recovery
+    pumpNotifications();
+    updateLinkQuality();
+    runBenchmark();
+    runLogExport();
 }
 
 void BleServerBBLH::onStateChange(StateCallback cb) {
@@ -49,102 +88,824 @@ void BleServerBBLH::onCommand(CommandCallback cb) {
 void BleServerBBLH::notifyStatus(const char* text) {
     if (!chrStatus_) return;
 
-    // Notify only if a client is connected
-    if (server_ && server_->getConnectedCount() > 0) {
-        chrStatus_->setValue(text);
-        chrStatus_->notify();
-        ESP_LOGD(TAG, "Notify STATUS: %s", text);
+    // Value kept for READ, then queued for the subscribers
+    chrStatus_->setValue(text);
+
+    enqueueNotify(NotifyLane::STATUS, Outbound::BROADCAST,
+        reinterpret_cast<const uint8_t*>(text), strlen(text), KEY_STATUS_TEXT);
+}
+
+// notify() copies the frame into an mbuf right away and fails with
+// BLE_HS_ENOMEM when the pool is empty; its completion callback fires
+// inside the call, so the pool itself is the only real flow control.
+// CONTROL / FAULT may dig into the reserve, the rest may not.
+static bool txBufferFree(NotifyLane lane) {
+    const int reserve = lane <= NotifyLane::FAULT ? 0 : NOTIFY_MBUF_RESERVE;
+    return os_msys_num_free() > reserve;
+}
+
+bool BleServerBBLH::sendFrame(NotifyLane lane, const uint8_t* data, size_t len, uint8_t key) {
+    return enqueueNotify(lane, Outbound::BROADCAST, data, len, key);
+}
+
+bool BleServerBBLH::enqueueNotify(NotifyLane lane, uint16_t target, const uint8_t* data, size_t len, uint8_t key) {
+    portENTER_CRITICAL(&outboundMux_);
+    const bool ok = outbound_.enqueue(lane, target, data, len, micros(), key);
+    portEXIT_CRITICAL(&outboundMux_);
+
+    if (!ok) {
+        ESP_LOGW(TAG, "Notify refused on %s lane (%u bytes)",
+            notifyLaneToString(lane), static_cast<unsigned>(len));
+    }
+    return ok;
+}
+
+// Sends queued frames by priority while the stack has buffers. The send
+// itself runs outside the critical section; complete() keeps a frame
+// that was coalesced meanwhile so its newer value still goes out, and a
+// broadcast cut short only goes to the subscribers it missed next time.
+void BleServerBBLH::pumpNotifications() {
+    Outbound::Message msg;
+
+    for (;;) {
+        portENTER_CRITICAL(&outboundMux_);
+        const bool have = outbound_.next(msg);
+        portEXIT_CRITICAL(&outboundMux_);
+        if (!have || !txBufferFree(msg.lane)) return;
+
+        bool deliverable = false;
+        portENTER_CRITICAL(&peersMux_);
+        if (msg.target == Outbound::BROADCAST) {
+            deliverable = peers_.hasSubscriber();
+        } else {
+            const Peers::Slot* peer = peers_.find(msg.target);
+            deliverable = peer && peer->subscribed;
+        }
+        portEXIT_CRITICAL(&peersMux_);
+
+        uint16_t reached[MAX_PEERS];
+        size_t issued = 0;
+        bool done = false;
+        if (deliverable) {
+            if (msg.target == Outbound::BROADCAST) {
+                issued = notifyAll(msg, reached, done);
+            } else {
+                done = notifyTo(msg.target, msg.data, msg.len);
+                issued = done ? 1 : 0;
+            }
+        }
+
+        portENTER_CRITICAL(&outboundMux_);
+        if (!deliverable) {
+            outbound_.discard(msg);
+        } else if (done) {
+            outbound_.complete(msg, issued + msg.reachedCount, micros());
+        } else {
+            outbound_.markReached(msg, reached, issued);
+        }
+        portEXIT_CRITICAL(&outboundMux_);
+
+        if (deliverable && !done) return;   // out of buffers, retry next loop
+    }
+}
+
+// Notifies the subscribers `msg` has not reached yet, stopping when the
+// buffers run out. Returns how many the stack accepted (listed in
+// `reached`); `done` when none is left. The subscriber list is copied
+// under the lock, the stack is called outside it.
+size_t BleServerBBLH::notifyAll(const Outbound::Message& msg, uint16_t (&reached)[MAX_PEERS], bool& done) {
+    uint16_t targets[MAX_PEERS];
+    portENTER_CRITICAL(&peersMux_);
+    const size_t count = peers_.subscribers(targets);
+    portEXIT_CRITICAL(&peersMux_);
+
+    size_t accepted = 0;
+    done = true;
+    for (size_t i = 0; i < count; ++i) {
+        if (msg.hasReached(targets[i])) continue;
+        if (!txBufferFree(msg.lane) || !notifyTo(targets[i], msg.data, msg.len)) {
+            done = false;
+            break;
+        }
+        reached[accepted++] = targets[i];
+    }
+    return accepted;
+}
+
+bool BleServerBBLH::notifyTo(uint16_t connHandle, const uint8_t* data, size_t len) {
+    if (!chrStatus_) return false;
+
+    const uint32_t t0 = micros();
+    const bool ok = chrStatus_->notify(data, len, connHandle);
+    const uint32_t us = micros() - t0;
+
+    // The peer may have gone meanwhile
+    portENTER_CRITICAL(&peersMux_);
+    Peers::Slot* peer = peers_.find(connHandle);
+    if (peer) {
+        Peers::recordNotify(*peer, ok, us);
+        peer->ext.monitor.addTxResult(ok);
+    }
+    portEXIT_CRITICAL(&peersMux_);
+    return ok;
+}
+
+void BleServerBBLH::logOutboundStats() {
+    NotifyLaneStats copies[NOTIFY_LANE_COUNT];
+    portENTER_CRITICAL(&outboundMux_);
+    for (size_t l = 0; l < NOTIFY_LANE_COUNT; ++l) {
+        copies[l] = outbound_.stats(static_cast<NotifyLane>(l));
+    }
+    portEXIT_CRITICAL(&outboundMux_);
+
+    for (size_t l = 0; l < NOTIFY_LANE_COUNT; ++l) {
+        const NotifyLane lane = static_cast<NotifyLane>(l);
+        const NotifyLaneStats& st = copies[l];
+        if (!st.enqueued && !st.sent) continue;
+
+        ESP_LOGD(TAG, "Lane %s: in=%lu sent=%lu coalesced=%lu dropped=%lu avg=%lu us max=%lu us",
+            notifyLaneToString(lane),
+            static_cast<unsigned long>(st.enqueued),
+            static_cast<unsigned long>(st.sent),
+            static_cast<unsigned long>(st.coalesced),
+            static_cast<unsigned long>(st.dropped),
+            static_cast<unsigned long>(st.avgUs()),
+            static_cast<unsigned long>(st.maxUs));
+    }
+}
+
+size_t BleServerBBLH::getPeerCount() const {
+    portENTER_CRITICAL(&peersMux_);
+    const size_t count = peers_.count();
+    portEXIT_CRITICAL(&peersMux_);
+    return count;
+}
+
+void BleServerBBLH::logPeerStats() {
+    Peers::Slot copies[MAX_PEERS];
+    size_t count = 0;
+    portENTER_CRITICAL(&peersMux_);
+    peers_.forEach([&](Peers::Slot& peer) { copies[count++] = peer; });
+    portEXIT_CRITICAL(&peersMux_);
+
+    for (size_t i = 0; i < count; ++i) {
+        const Peers::Slot& peer = copies[i];
+        ESP_LOGD(TAG, "Peer %u %s role=%s notify ok=%lu fail=%lu avg=%lu us max=%lu us",
+            static_cast<unsigned>(peer.connHandle),
+            peer.ext.address.toString().c_str(),
+            peerRoleToString(peer.role),
+            static_cast<unsigned long>(peer.notify.ok),
+            static_cast<unsigned long>(peer.notify.failed),
+            static_cast<unsigned long>(peer.notify.avgUs()),
+            static_cast<unsigned long>(peer.notify.maxUs));
+    }
+}
+
+// ===== Control frames (handled here, never forwarded to the app) =====
+bool BleServerBBLH::handleControlFrame(uint16_t connHandle, const uint8_t* data, size_t len) {
+    if (!BleProto::isBinaryFrame(data, len)) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&peersMux_);
+    const bool known = peers_.find(connHandle) != nullptr;
+    portEXIT_CRITICAL(&peersMux_);
+    if (!known) {
+        return true;   // unknown link, drop
+    }
+
+    switch (static_cast<BleProto::Op>(data[0])) {
+        case BleProto::Op::HELLO: {
+            const PeerRole role = len >= 2 ? static_cast<PeerRole>(data[1]) : PeerRole::NONE;
+            portENTER_CRITICAL(&peersMux_);
+            const bool claimed = peers_.claimRole(connHandle, role);
+            portEXIT_CRITICAL(&peersMux_);
+
+            if (claimed) {
+                ESP_LOGI(TAG, "Peer %u role -> %s",
+                    static_cast<unsigned>(connHandle), peerRoleToString(role));
+                refreshAdvStatus();
+            } else {
+                ESP_LOGW(TAG, "Peer %u role %s refused",
+                    static_cast<unsigned>(connHandle), peerRoleToString(role));
+                static const char denied[] = "ROLE_DENIED";
+                enqueueNotify(NotifyLane::CONTROL, connHandle,
+                    reinterpret_cast<const uint8_t*>(denied), sizeof(denied) - 1);
+            }
+            return true;
+        }
+
+        case BleProto::Op::LINK_TX:
+            if (len >= 2) {
+                const int8_t peerTxDbm = static_cast<int8_t>(data[1]);
+                portENTER_CRITICAL(&peersMux_);
+                Peers::Slot* peer = peers_.find(connHandle);
+                if (peer) peer->ext.peerTxDbm = peerTxDbm;
+                portEXIT_CRITICAL(&peersMux_);
+
+                ESP_LOGD(TAG, "Peer %u TX power = %d dBm",
+                    static_cast<unsigned>(connHandle), peerTxDbm);
+            }
+            return true;
+
+        case BleProto::Op::LOG_EXPORT:
+            startLogExport(connHandle, len >= 5 ? BleProto::getU32(data + 1) : 0);
+            return true;
+
+        case BleProto::Op::BOOT_REPORT: {
+            if (!bootTimeline_) return true;
+
+            uint8_t frame[BOOT_REPORT_HEADER + BOOT_MILESTONE_COUNT * BOOT_REPORT_ENTRY];
+            const size_t mtuPayload = server_->getPeerMTU(connHandle) - 3;
+            const size_t maxLen = mtuPayload < sizeof(frame) ? mtuPayload : sizeof(frame);
+
+            frame[0] = static_cast<uint8_t>(BleProto::Op::BOOT_REPORT);
+            const size_t len = 1 + bootTimeline_->encode(frame + 1, maxLen - 1);
+            enqueueNotify(NotifyLane::CONTROL, connHandle, frame, len);
+            return true;
+        }
+
+        case BleProto::Op::BENCH_START: {
+            BleBench::Config config;
+            if (!BleBench::decodeConfig(data + 1, len - 1, config)) {
+                ESP_LOGW(TAG, "Benchmark: bad config");
+                return true;
+            }
+            const uint16_t maxPayload = server_->getPeerMTU(connHandle) - 3;
+            portENTER_CRITICAL(&benchMux_);
+            benchReportPending_ = false;
+            benchConn_ = connHandle;
+            bench_.start(config, millis(), maxPayload);
+            const uint16_t payload = bench_.config().payloadSize;
+            portEXIT_CRITICAL(&benchMux_);
+
+            ESP_LOGI(TAG, "Benchmark start: dir=%u payload=%u",
+                static_cast<unsigned>(config.direction),
+                static_cast<unsigned>(payload));
+            return true;
+        }
+
+        case BleProto::Op::BENCH_DATA:
+            portENTER_CRITICAL(&benchMux_);
+            if (connHandle == benchConn_) {
+                bench_.onFrame(data, len);
+            }
+            portEXIT_CRITICAL(&benchMux_);
+            return true;
+
+        case BleProto::Op::BENCH_STOP:
+            portENTER_CRITICAL(&benchMux_);
+            if (connHandle == benchConn_) {
+                bench_.stop(millis());
+                benchReportPending_ = true;
+            }
+            portEXIT_CRITICAL(&benchMux_);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// ===== Throughput benchmark =====
+void BleServerBBLH::runBenchmark() {
+    const uint32_t now = millis();
+
+    portENTER_CRITICAL(&benchMux_);
+    const bool reportPending = benchReportPending_;
+    benchReportPending_ = false;
+    const uint16_t conn = benchConn_;
+    BleBench::Report report;
+    if (reportPending) {
+        report = bench_.report(BleBench::Role::SERVER, 0);
+    }
+    if (!reportPending && bench_.running() && !bench_.sending(now) &&
+        bench_.overdue(now, BENCH_STOP_GRACE_MS)) {
+        bench_.stop(now);   // BBLC sends STOP; only bail out if it never does
+    }
+    const bool flood = !reportPending && bench_.sending(now) &&
+                       bench_.config().direction == BleBench::Direction::NOTIFY;
+    portEXIT_CRITICAL(&benchMux_);
+
+    if (reportPending) {
+        if (conn == BLE_HS_CONN_HANDLE_NONE) {
+            return;   // BBLC left before the report went out
+        }
+
+        report.effectiveMtu = server_->getPeerMTU(conn);
+
+        uint8_t frame[1 + BleBench::REPORT_SIZE];
+        frame[0] = static_cast<uint8_t>(BleProto::Op::BENCH_REPORT);
+        BleBench::encodeReport(report, frame + 1);
+
+        enqueueNotify(NotifyLane::CONTROL, conn, frame, sizeof(frame));
+        return;
+    }
+
+    if (!flood) {
+        return;
+    }
+
+    static uint8_t frame[BLE_ATT_ATTR_MAX_LEN];
+    const uint32_t sliceStart = millis();
+
+    // Same buffer budget as BULK: the flood never starves acks. Frames are
+    // built under the lock, a STOP or disconnect in between ends the burst.
+    while (millis() - sliceStart < BENCH_SLICE_MS && txBufferFree(NotifyLane::BULK)) {
+        portENTER_CRITICAL(&benchMux_);
+        const bool go = benchConn_ == conn && bench_.sending(millis());
+        const size_t len = go ? bench_.nextFrame(frame) : 0;
+        portEXIT_CRITICAL(&benchMux_);
+        if (!go) break;
+
+        const uint32_t t0 = micros();
+        const bool ok = chrStatus_->notify(frame, len, conn);
+        const uint32_t cpuUs = micros() - t0;
+
+        portENTER_CRITICAL(&benchMux_);
+        if (benchConn_ == conn) {
+            bench_.recordSend(ok, len, cpuUs);
+        }
+        portEXIT_CRITICAL(&benchMux_);
+        if (!ok) break;
+    }
+}
+
+// ===== Launch history export =====
+void BleServerBBLH::startLogExport(uint16_t connHandle, uint32_t fromSeq) {
+    if (!launchLog_ || !chrLog_) {
+        ESP_LOGW(TAG, "Launch log export unavailable");
+        return;
+    }
+
+    // Cursor is set up from loop(), only post the request here
+    portENTER_CRITICAL(&peersMux_);
+    exportRequest_.connHandle = connHandle;
+    exportRequest_.fromSeq = fromSeq;
+    exportRequest_.pending = true;
+    portEXIT_CRITICAL(&peersMux_);
+}
+
+// Streams MTU-sized batches of records on LOG. A batch that cannot be
+// queued (no notify buffer) is kept and retried on the next loop.
+void BleServerBBLH::runLogExport() {
+    static constexpr size_t MAX_PER_BATCH = (LOG_FRAME_MAX - BleProto::LOG_BATCH_HEADER) / LAUNCH_RECORD_SIZE;
+    static LaunchRecord records[MAX_PER_BATCH];
+    static uint8_t frame[LOG_FRAME_MAX];
+
+    // Take a request posted by the host task; export state below is loop() only
+    portENTER_CRITICAL(&peersMux_);
+    const ExportRequest request = exportRequest_;
+    exportRequest_.pending = false;
+    if (request.pending) {
+        exportConn_ = request.connHandle;
+        exportFromSeq_ = request.fromSeq;
+    }
+    const bool linkUp = exportConn_ != BLE_HS_CONN_HANDLE_NONE && peers_.find(exportConn_);
+    portEXIT_CRITICAL(&peersMux_);
+
+    if (request.pending) {
+        exportCursor_ = launchLog_->oldest();
+        exportFrameLen_ = 0;
+        ESP_LOGI(TAG, "Launch log export from seq %lu",
+            static_cast<unsigned long>(exportFromSeq_));
+    }
+
+    if (!linkUp) {
+        exportConn_ = BLE_HS_CONN_HANDLE_NONE;
+        return;
+    }
+
+    const size_t payload = server_->getPeerMTU(exportConn_) - 3;
+    if (payload < BleProto::LOG_BATCH_HEADER + LAUNCH_RECORD_SIZE) {
+        ESP_LOGW(TAG, "Launch log export needs MTU >= %u",
+            static_cast<unsigned>(BleProto::LOG_BATCH_HEADER + LAUNCH_RECORD_SIZE + 3));
+        exportConn_ = BLE_HS_CONN_HANDLE_NONE;
+        return;
+    }
+
+    size_t perBatch = (payload - BleProto::LOG_BATCH_HEADER) / LAUNCH_RECORD_SIZE;
+    if (perBatch > MAX_PER_BATCH) perBatch = MAX_PER_BATCH;
+
+    const uint32_t sliceStart = millis();
+    while (millis() - sliceStart < LOG_EXPORT_SLICE_MS) {
+        if (exportFrameLen_ == 0) {
+            size_t count = 0;
+
+            while (count < perBatch && !launchLog_->exhausted(exportCursor_)) {
+                const size_t n = launchLog_->readBatch(exportCursor_, records + count, perBatch - count);
+
+                // Drop records the client already has
+                size_t kept = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    if (records[count + i].seq >= exportFromSeq_) {
+                        records[count + kept++] = records[count + i];
+                    }
+                }
+                count += kept;
+            }
+
+            const bool last = launchLog_->exhausted(exportCursor_);
+            frame[0] = last ? BleProto::LOG_BATCH_LAST : 0;
+            frame[1] = static_cast<uint8_t>(count);
+            memcpy(frame + BleProto::LOG_BATCH_HEADER, records, count * LAUNCH_RECORD_SIZE);
+            exportFrameLen_ = BleProto::LOG_BATCH_HEADER + count * LAUNCH_RECORD_SIZE;
+        }
+
+        // Bulk lane: only when nothing more urgent waits and buffers are left
+        portENTER_CRITICAL(&outboundMux_);
+        const bool allowed = outbound_.bulkAllowed();
+        portEXIT_CRITICAL(&outboundMux_);
+        if (!allowed || !txBufferFree(NotifyLane::BULK)) {
+            return;
+        }
+
+        if (!chrLog_->notify(frame, exportFrameLen_, exportConn_)) {
+            return;   // out of buffers, retry next loop
+        }
+
+        portENTER_CRITICAL(&outboundMux_);
+        outbound_.bulkSent();
+        portEXIT_CRITICAL(&outboundMux_);
+
+        const bool last = frame[0] & BleProto::LOG_BATCH_LAST;
+        exportFrameLen_ = 0;
+
+        if (last) {
+            ESP_LOGI(TAG, "Launch log export done");
+            exportConn_ = BLE_HS_CONN_HANDLE_NONE;
+            return;
+        }
+    }
+}
+
+// ===== Adaptive TX power =====
+// Each peer runs its own controller; the radio uses the highest level
+// any connected peer needs.
+void BleServerBBLH::updateLinkQuality() {
+    const uint32_t now = millis();
+    if (now - lastLinkSampleMs_ < LINK_SAMPLE_PERIOD_MS) {
+        return;
+    }
+    lastLinkSampleMs_ = now;
+
+    uint16_t handles[MAX_PEERS];
+    portENTER_CRITICAL(&peersMux_);
+    const size_t count = peers_.handles(handles);
+    portEXIT_CRITICAL(&peersMux_);
+    if (count == 0) {
+        return;
+    }
+
+    // RSSI reads go through the host, outside the lock
+    int8_t rssi[MAX_PEERS];
+    bool hasRssi[MAX_PEERS];
+    for (size_t i = 0; i < count; ++i) {
+        hasRssi[i] = ble_gap_conn_rssi(handles[i], &rssi[i]) == 0;
+    }
+
+    uint8_t needed = 0;
+    portENTER_CRITICAL(&peersMux_);
+    for (size_t i = 0; i < count; ++i) {
+        Peers::Slot* peer = peers_.find(handles[i]);
+        if (!peer) continue;   // disconnected meanwhile
+
+        PeerLink& link = peer->ext;
+        if (hasRssi[i]) {
+            link.monitor.addRssi(rssi[i]);
+        }
+
+        link.txPower.update(link.monitor.snapshot(), link.peerTxDbm);
+        link.monitor.startWindow();
+
+        if (link.txPower.level() > needed) {
+            needed = link.txPower.level();
+        }
+    }
+    portEXIT_CRITICAL(&peersMux_);
+
+    if (needed != txLevel_) {
+        txLevel_ = needed;
+        bleApplyTxPowerLevel(txLevel_);
+        ESP_LOGI(TAG, "TX power -> %d dBm (~%u mA, %u peers)",
+            getTxPowerDbm(),
+            static_cast<unsigned>(getTxCurrentMa()),
+            static_cast<unsigned>(count));
+        publishTxPower();
+    }
+}
+
+void BleServerBBLH::resetTxPower() {
+    txLevel_ = TX_POWER_LEVEL_MAX;
+    bleApplyTxPowerLevel(txLevel_);
+}
+
+void BleServerBBLH::publishTxPower() {
+    const uint8_t frame[] = {
+        static_cast<uint8_t>(BleProto::Op::LINK_TX),
+        static_cast<uint8_t>(getTxPowerDbm()),
+    };
+    enqueueNotify(NotifyLane::TELEMETRY, Outbound::BROADCAST, frame, sizeof(frame), frame[0]);
+}
+
+bool BleServerBBLH::dispatch(BleEvent event) {
+    if (sm_.dispatch(event, millis())) return true;
+
+    ESP_LOGW(TAG, "Event %s ignored in state %s",
+        bleEventToString(event), bleStateToString(sm_.state()));
+    return false;
+}
+
+void BleServerBBLH::drainEvents() {
+    BleEvent event;
+    while (events_.pop(event)) {
+        dispatch(event);
     }
 }
 
-void BleServerBBLH::setState(BleState s) {
-    if (state_ == s) return;
-    state_ = s;
+// State entry actions; the transition table lives in BleStateMachine.h
+void BleServerBBLH::onTransition(BleState from, BleState to, BleEvent event) {
+    ESP_LOGI(TAG, "State %s -> %s (%s)",
+        bleStateToString(from), bleStateToString(to), bleEventToString(event));
 
-    ESP_LOGI(TAG, "State -> %d", static_cast<int>(state_));
+    // Notify first: an entry action may chain another transition
+    if (stateCb_) stateCb_(to);
 
-    if (stateCb_) stateCb_(state_);
+    switch (to) {
+        case BleState::ADVERTISING:
+            enterAdvertising();
+            break;
+
+        case BleState::ERROR:
+            NimBLEDevice::getAdvertising()->stop();
+            break;
+
+        default:
+            break;
+    }
+}
+
+void BleServerBBLH::logStateStats() const {
+    ESP_LOGI(TAG, "State %s since %lu ms, %lu rejected events",
+        bleStateToString(sm_.state()),
+        static_cast<unsigned long>(sm_.timeInStateMs(millis())),
+        static_cast<unsigned long>(sm_.rejectedCount()));
+
+    sm_.forEachTakenEdge([](BleState from, BleEvent event, BleState to, const BleDwellStats& d) {
+        ESP_LOGI(TAG, "  %s -%s-> %s: n=%lu avg=%lu ms max=%lu ms",
+            bleStateToString(from), bleEventToString(event), bleStateToString(to),
+            static_cast<unsigned long>(d.count),
+            static_cast<unsigned long>(d.avgMs()),
+            static_cast<unsigned long>(d.maxMs));
+    });
 }
 
 void BleServerBBLH::setupGatt() {
-    service_ = server_->createService(UUID_BBLH_SERVICE);
+    // Service table generated from the shared schema (BblhGattSchema.h)
+    NimBLECharacteristic* chars[BblhGatt::CHAR_COUNT];
+    service_ = BblhGatt::buildServer(server_, chars);
 
     // CMD: Write (client -> server)
-    chrCmd_ = service_->createCharacteristic(
-        UUID_BBLH_CMD,
-        NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR
-    );
+    chrCmd_ = chars[static_cast<size_t>(BblhGatt::CharId::CMD)];
     chrCmd_->setCallbacks(&cmdCallbacks_);
 
     // STATUS: Notify (server -> client)
-    chrStatus_ = service_->createCharacteristic(
-        UUID_BBLH_STATUS,
-        NIMBLE_PROPERTY::NOTIFY | NIMBLE_PROPERTY::READ
-    );
+    chrStatus_ = chars[static_cast<size_t>(BblhGatt::CharId::STATUS)];
+    chrStatus_->setCallbacks(&statusCallbacks_);
     chrStatus_->setValue("READY");
 
+    // LOG: launch history export batches
+    chrLog_ = chars[static_cast<size_t>(BblhGatt::CharId::LOG)];
+
     service_->start();
 
     ESP_LOGI(TAG, "GATT ready (service + characteristics)");
 }
 
 void BleServerBBLH::startAdvertising() {
+    dispatch(BleEvent::START);   // work done on entering ADVERTISING
+}
+
+void BleServerBBLH::enterAdvertising() {
     NimBLEAdvertising* adv = NimBLEDevice::getAdvertising();
 
     adv->reset();
-    adv->setAppearance(0x0000);
-    adv->addServiceUUID(UUID_BBLH_SERVICE);
+    adv->addServiceUUID(BblhGatt::serviceUuid());
+
+    // No appearance field: flags + service UUID + status record fill the 31 bytes
+    portENTER_CRITICAL(&peersMux_);
+    const AdvStatus status = advStatus_;
+    portEXIT_CRITICAL(&peersMux_);
+    applyAdvStatus(adv, status);
 
     // Scan response packet
     NimBLEAdvertisementData scanResponse;
     scanResponse.setName("BBLH");
     adv->setScanResponseData(scanResponse);
 
-    adv->start();
+    // Advertise at full power so heads stay discoverable
+    resetTxPower();
+
+    if (!adv->start()) {
+        ESP_LOGE(TAG, "Advertising start failed");
+        dispatch(BleEvent::FAULT);   // retried on ERROR timeout
+        return;
+    }
 
     ESP_LOGI(TAG, "Advertising started (%s)",
         serverAddress_.toString().c_str());
-    setState(BleState::ADVERTISING);
+}
+
+// ===== Advertised status =====
+void BleServerBBLH::setHeadStatus(bool ready, bool armed, uint8_t batteryPct, bool fault) {
+    portENTER_CRITICAL(&peersMux_);
+    appStatusFlags_ = (ready ? AdvStatusFlag::READY : 0) |
+                      (armed ? AdvStatusFlag::ARMED : 0) |
+                      (fault ? AdvStatusFlag::FAULT : 0);
+    batteryPct_ = batteryPct;
+    portEXIT_CRITICAL(&peersMux_);
+    refreshAdvStatus();
+}
+
+// Recomputes the record; only touches the controller when something changed.
+// Runs from both the loop and the NimBLE callbacks.
+void BleServerBBLH::refreshAdvStatus() {
+    portENTER_CRITICAL(&peersMux_);
+    uint8_t flags = appStatusFlags_;
+    if (peers_.hasRole(PeerRole::CONTROLLER)) flags |= AdvStatusFlag::HAS_CONTROLLER;
+    if (!peers_.full())                       flags |= AdvStatusFlag::SLOT_FREE;
+
+    const bool changed = flags != advStatus_.flags || batteryPct_ != advStatus_.batteryPct;
+    if (changed) {
+        advStatus_.flags = flags;
+        advStatus_.batteryPct = batteryPct_;
+        ++advStatus_.seq;
+    }
+    const AdvStatus status = advStatus_;
+    portEXIT_CRITICAL(&peersMux_);
+
+    if (!changed) {
+        return;
+    }
+
+    NimBLEAdvertising* adv = NimBLEDevice::getAdvertising();
+    applyAdvStatus(adv, status);
+    if (adv->isAdvertising()) {
+        adv->refreshAdvertisingData();
+    }
+
+    ESP_LOGD(TAG, "Advertised status flags=0x%02x battery=%u seq=%u",
+        status.flags, status.batteryPct, status.seq);
+}
+
+void BleServerBBLH::applyAdvStatus(NimBLEAdvertising* adv, const AdvStatus& status) {
+    uint8_t data[AdvStatusFormat::DATA_SIZE];
+    encodeAdvStatus(status, data);
+    adv->setManufacturerData(std::string(reinterpret_cast<const char*>(data), sizeof(data)));
+}
+
+// Keeps advertising while slots are free, without touching the state
+// or the TX power of the connected peers.
+void BleServerBBLH::resumeAdvertising() {
+    NimBLEAdvertising* adv = NimBLEDevice::getAdvertising();
+
+    portENTER_CRITICAL(&peersMux_);
+    const size_t used = peers_.count();
+    portEXIT_CRITICAL(&peersMux_);
+
+    if (used == Peers::capacity()) {
+        if (adv->isAdvertising()) adv->stop();
+        return;
+    }
+
+    if (!adv->isAdvertising()) {
+        adv->start();
+        ESP_LOGI(TAG, "Advertising resumed (%u/%u slots used)",
+            static_cast<unsigned>(used),
+            static_cast<unsigned>(Peers::capacity()));
+    }
 }
 
 // ===== Server callbacks =====
 void BleServerBBLH::ServerCallbacks::onConnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo) {
-    parent_.lastClientAddress_ = connInfo.getAddress();
-    parent_.hasClientAddress_ = true;
+    const NimBLEAddress address = connInfo.getAddress();
+    const uint32_t now = millis();
+
+    portENTER_CRITICAL(&parent_.peersMux_);
+    Peers::Slot* peer = parent_.peers_.add(connInfo.getConnHandle(), now);
+    if (peer) peer->ext.address = address;
+    const size_t count = parent_.peers_.count();
+    portEXIT_CRITICAL(&parent_.peersMux_);
+
+    if (!peer) {
+        ESP_LOGW(TAG, "No free slot, rejecting %s", address.toString().c_str());
+        pServer->disconnect(connInfo.getConnHandle());
+        return;
+    }
 
-    ESP_LOGI(TAG, "Client connected from %s",
-        parent_.lastClientAddress_.toString().c_str());
+    ESP_LOGI(TAG, "Client connected from %s (%u/%u)",
+        address.toString().c_str(),
+        static_cast<unsigned>(count),
+        static_cast<unsigned>(Peers::capacity()));
 
-    parent_.setState(BleState::CONNECTED);
+    if (count == 1 && !parent_.events_.post(BleEvent::LINK_UP)) {
+        ESP_LOGE(TAG, "BLE event queue full, LINK_UP dropped");
+    }
+    parent_.resumeAdvertising();
+    parent_.refreshAdvStatus();
 }
 
 void BleServerBBLH::ServerCallbacks::onDisconnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo, int reason) {
-    parent_.lastClientAddress_ = connInfo.getAddress();
-    parent_.hasClientAddress_ = true;
+    const uint16_t connHandle = connInfo.getConnHandle();
 
     ESP_LOGW(TAG,
             "Client disconnected from %s (reason=%d)",
-            parent_.lastClientAddress_.toString().c_str(),
+            connInfo.getAddress().toString().c_str(),
             reason);
 
-    parent_.setState(BleState::DISCONNECTED);
-    parent_.startAdvertising();
+    portENTER_CRITICAL(&parent_.peersMux_);
+    const bool hadSlot = parent_.peers_.remove(connHandle);
+    const bool empty = parent_.peers_.empty();
+    portEXIT_CRITICAL(&parent_.peersMux_);
+
+    if (!hadSlot) {
+        return;   // rejected connection, never had a slot
+    }
+
+    portENTER_CRITICAL(&parent_.outboundMux_);
+    parent_.outbound_.dropTarget(connHandle);
+    portEXIT_CRITICAL(&parent_.outboundMux_);
+
+    portENTER_CRITICAL(&parent_.benchMux_);
+    if (connHandle == parent_.benchConn_) {
+        parent_.bench_.stop(millis());
+        parent_.benchConn_ = BLE_HS_CONN_HANDLE_NONE;
+    }
+    portEXIT_CRITICAL(&parent_.benchMux_);
+
+    parent_.refreshAdvStatus();
+
+    if (empty) {
+        // Advertising restarts from loop(), on entering ADVERTISING
+        if (!parent_.events_.post(BleEvent::LINK_LOST) || !parent_.events_.post(BleEvent::START)) {
+            ESP_LOGE(TAG, "BLE event queue full, link loss dropped");
+        }
+    } else {
+        parent_.resumeAdvertising();
+    }
 }
 
 // ===== CMD write callback =====
 void BleServerBBLH::CmdCallbacks::onWrite(NimBLECharacteristic* pCharacteristic, NimBLEConnInfo& connInfo) {
     std::string value = pCharacteristic->getValue();
 
+    if (value.size() == 0) return;
+
+    const uint16_t connHandle = connInfo.getConnHandle();
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(value.data());
+    if (parent_.handleControlFrame(connHandle, data, value.size())) {
+        return;
+    }
+
     ESP_LOGI(TAG, "CMD write (%d bytes)", static_cast<int>(value.size()));
 
-    if (value.size() == 0) return;
+    // Role-based permission: only the controller may fire
+    portENTER_CRITICAL(&parent_.peersMux_);
+    const bool canFire = parent_.peers_.canFire(connHandle);
+    portEXIT_CRITICAL(&parent_.peersMux_);
+
+    if (static_cast<BleProto::Op>(data[0]) == BleProto::Op::FIRE && !canFire) {
+        ESP_LOGW(TAG, "FIRE refused from peer %u", static_cast<unsigned>(connHandle));
+        static const char denied[] = "DENIED";
+        parent_.enqueueNotify(NotifyLane::CONTROL, connHandle,
+            reinterpret_cast<const uint8_t*>(denied), sizeof(denied) - 1);
+        return;
+    }
 
     if (parent_.cmdCb_) {
-        parent_.cmdCb_(
-            reinterpret_cast<const uint8_t*>(value.data()),
-            value.size()
-        );
+        parent_.cmdCb_(data, value.size());
     }
 
-    parent_.notifyStatus("CMD_RX");
+    // Command ack to the sender only: control lane, never held back by status / telemetry
+    static const char ack[] = "CMD_RX";
+    parent_.enqueueNotify(NotifyLane::CONTROL, connHandle,
+        reinterpret_cast<const uint8_t*>(ack), sizeof(ack) - 1);
+}
+
+// ===== STATUS subscribe callback =====
+void BleServerBBLH::StatusCallbacks::onSubscribe(NimBLECharacteristic* pCharacteristic, NimBLEConnInfo& connInfo, uint16_t subValue) {
+    if (pCharacteristic != parent_.chrStatus_) return;   // STATUS subscribers only
+
+    const uint16_t connHandle = connInfo.getConnHandle();
+    const bool subscribed = subValue != 0;
+
+    portENTER_CRITICAL(&parent_.peersMux_);
+    Peers::Slot* peer = parent_.peers_.find(connHandle);
+    if (peer) peer->subscribed = subscribed;
+    portEXIT_CRITICAL(&parent_.peersMux_);
+
+    if (!peer) return;
+    ESP_LOGI(TAG, "Peer %u %s STATUS",
+        static_cast<unsigned>(connHandle),
+        subscribed ? "subscribed to" : "unsubscribed from");
 }
@@ -5,8 +5,16 @@
 #include <NimBLEDevice.h>
 #include <functional>
 
-// Uses the same enum as BBLC/BleStatus (important for LED and coherence)
-#include "ble/BleStatus.h"
+#include "ble/AdvStatus.h"
+#include "ble/BblhGattSchema.h"
+#include "ble/BleBenchmark.h"
+// Same state enum and machine as BBLC (important for LED and coherence)
+#include "ble/BleStateMachine.h"
+#include "ble/LinkQuality.h"
+#include "ble/NotifyScheduler.h"
+#include "ble/PeerTable.h"
+#include "boot/BootTimeline.h"
+#include "storage/LaunchHistory.h"
 
 class BleServerBBLH {
 public:
@@ -18,26 +26,86 @@ public:
     BleServerBBLH();
 
     void begin();
-    void loop(); // currently empty, kept for symmetry and future evolution
+    // Drains the outbound queue and runs link quality, benchmark and log
+    // export; call from the Arduino loop()
+    void loop();
 
     void onStateChange(StateCallback cb);
     void onCommand(CommandCallback cb);
 
-    BleState getState() const { return state_; }
+    BleState getState() const { return sm_.state(); }
 
-    // Send a status notification to the client
+    // Time per state / transition, rejected events
+    void logStateStats() const;
+
+    // Send a status notification to every subscribed client (latest value wins)
     void notifyStatus(const char* text);
 
+    // Queue a frame for every subscriber on a priority lane (see NotifyScheduler.h).
+    // key: coalescing key for STATUS / TELEMETRY, usually the opcode.
+    bool sendFrame(NotifyLane lane, const uint8_t* data, size_t len, uint8_t key = 0);
+
+    // Head status broadcast in advertising data (read by BBLC without connecting)
+    void setHeadStatus(bool ready, bool armed, uint8_t batteryPct = ADV_BATTERY_UNKNOWN, bool fault = false);
+
+    // Launch history exported over the LOG characteristic
+    void attachLaunchLog(LaunchHistory& log) { launchLog_ = &log; }
+
+    // Boot milestones sent back on BOOT_REPORT requests
+    void attachBootTimeline(const BootTimeline& timeline) { bootTimeline_ = &timeline; }
+
     // Local BLE server address
     const NimBLEAddress& getServerAddress() const {
         return serverAddress_;
     }
 
+    // Connected centrals (controller, referee...)
+    size_t getPeerCount() const;
+    void logPeerStats();
+    void logOutboundStats();
+
+    // TX power actually applied (max over the peers' needs)
+    int8_t getTxPowerDbm() const { return TX_POWER_LEVELS[txLevel_].dbm; }
+    uint8_t getTxCurrentMa() const { return TX_POWER_LEVELS[txLevel_].currentMa; }
+
 private:
-    void setState(BleState s);
+    // Per-connection link data
+    struct PeerLink {
+        NimBLEAddress address;
+        LinkQualityMonitor monitor;
+        TxPowerController txPower;
+        int8_t peerTxDbm = TX_POWER_LEVELS[TX_POWER_LEVEL_MAX].dbm;
+    };
+
+    // Matches CONFIG_BT_NIMBLE_MAX_CONNECTIONS (default 3)
+    static constexpr size_t MAX_PEERS = 3;
+    using Peers = PeerTable<MAX_PEERS, PeerLink>;
+
+    // Outbound STATUS traffic; bench and boot reports fit a slot
+    using Outbound = NotifyScheduler<8, BblhGatt::STATUS_FRAME_MAX, MAX_PEERS>;
+
+    bool dispatch(BleEvent event);
+    void drainEvents();
+    void onTransition(BleState from, BleState to, BleEvent event);
 
     void setupGatt();
     void startAdvertising();
+    void enterAdvertising();
+    void resumeAdvertising();
+    void refreshAdvStatus();
+    void applyAdvStatus(NimBLEAdvertising* adv, const AdvStatus& status);
+
+    bool enqueueNotify(NotifyLane lane, uint16_t target, const uint8_t* data, size_t len, uint8_t key = 0);
+    void pumpNotifications();
+    size_t notifyAll(const Outbound::Message& msg, uint16_t (&reached)[MAX_PEERS], bool& done);
+    bool notifyTo(uint16_t connHandle, const uint8_t* data, size_t len);
+    bool handleControlFrame(uint16_t connHandle, const uint8_t* data, size_t len);
+    void runBenchmark();
+    void startLogExport(uint16_t connHandle, uint32_t fromSeq);
+    void runLogExport();
+    void updateLinkQuality();
+    void resetTxPower();
+    void publishTxPower();
 
     // ====== NimBLE Callbacks ======
     class ServerCallbacks : public NimBLEServerCallbacks {
@@ -57,19 +125,73 @@ private:
         BleServerBBLH& parent_;
     };
 
+    class StatusCallbacks : public NimBLECharacteristicCallbacks {
+    public:
+        explicit StatusCallbacks(BleServerBBLH& parent) : parent_(parent) {}
+        void onSubscribe(NimBLECharacteristic* pCharacteristic, NimBLEConnInfo& connInfo, uint16_t subValue) override;
+    private:
+        BleServerBBLH& parent_;
+    };
+
 private:
-    BleState state_ = BleState::BOOT;
+    BleStateMachine sm_ {BleRole::SERVER};
     StateCallback stateCb_;
+    // Posted by the connect / disconnect callbacks (host task), dispatched
+    // in loop(): only the loop task touches the state machine
+    BleEventQueue<8> events_;
     CommandCallback cmdCb_;
 
     NimBLEServer* server_ = nullptr;
     NimBLEService* service_ = nullptr;
     NimBLECharacteristic* chrCmd_ = nullptr;
     NimBLECharacteristic* chrStatus_ = nullptr;
+    NimBLECharacteristic* chrLog_ = nullptr;
     
     ServerCallbacks serverCallbacks_;
     CmdCallbacks cmdCallbacks_;
-    bool hasClientAddress_ = false;
+    StatusCallbacks statusCallbacks_;
     NimBLEAddress serverAddress_;
-    NimBLEAddress lastClientAddress_;
+
+    // Touched by the NimBLE callbacks (host task) and loop(): peers_, the
+    // advertised record and the export request are only accessed under
+    // peersMux_, and the stack is never called while holding it
+    Peers peers_;
+    mutable portMUX_TYPE peersMux_ = portMUX_INITIALIZER_UNLOCKED;
+
+    // Filled from NimBLE callbacks and the app, drained in loop()
+    Outbound outbound_;
+    portMUX_TYPE outboundMux_ = portMUX_INITIALIZER_UNLOCKED;
+
+    // Advertised status record
+    AdvStatus advStatus_;
+    uint8_t appStatusFlags_ = 0;
+    uint8_t batteryPct_ = ADV_BATTERY_UNKNOWN;
+
+    // Adaptive TX power
+    uint8_t txLevel_ = TX_POWER_LEVEL_MAX;
+    uint32_t lastLinkSampleMs_ = 0;
+
+    // Throughput benchmark (driven by one BBLC). BENCH_* writes and
+    // disconnects arrive on the host task, the flood and the report run in
+    // loop(): all three only under benchMux_, never across a stack call
+    BleBench::Session bench_;
+    uint16_t benchConn_ = BLE_HS_CONN_HANDLE_NONE;
+    bool benchReportPending_ = false;
+    portMUX_TYPE benchMux_ = portMUX_INITIALIZER_UNLOCKED;
+
+    // Launch history export (one client at a time). The request is posted
+    // by the host task under peersMux_, the rest is loop() only.
+    struct ExportRequest {
+        bool pending = false;
+        uint16_t connHandle = BLE_HS_CONN_HANDLE_NONE;
+        uint32_t fromSeq = 0;
+    };
+
+    LaunchHistory* launchLog_ = nullptr;
+    const BootTimeline* bootTimeline_ = nullptr;
+    ExportRequest exportRequest_;
+    LaunchHistory::Cursor exportCursor_ {};
+    uint16_t exportConn_ = BLE_HS_CONN_HANDLE_NONE;
+    uint32_t exportFromSeq_ = 0;
+    size_t exportFrameLen_ = 0;          // batch waiting for a notify slot
 };
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <esp_partition.h>
+#include <esp_spi_flash.h>
+
+// =======================================================
+// Raw flash access to a data partition, in the shape LaunchLog
+// expects (see storage/LaunchLog.h in CommonUI).
+// =======================================================
+class EspPartitionFlash {
+public:
+    bool begin(const char* label) {
+        part_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+        return part_ != nullptr;
+    }
+
+    size_t size() const { return part_ ? part_->size : 0; }
+    size_t sectorSize() const { return SPI_FLASH_SEC_SIZE; }
+
+    bool read(uint32_t addr, void* dst, size_t len) {
+        return esp_partition_read(part_, addr, dst, len) == ESP_OK;
+    }
+
+    bool write(uint32_t addr, const void* src, size_t len) {
+        return esp_partition_write(part_, addr, src, len) == ESP_OK;
+    }
+
+    bool eraseSector(uint32_t index) {
+        return esp_partition_erase_range(part_, index * SPI_FLASH_SEC_SIZE, SPI_FLASH_SEC_SIZE) == ESP_OK;
+    }
+
+private:
+    const esp_partition_t* part_ = nullptr;
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "storage/EspPartitionFlash.h"
+#include "storage/LaunchLog.h"
+
+// Launch history stored in the "launchlog" partition (see partitions.csv)
+static constexpr const char* LAUNCH_LOG_PARTITION = "launchlog";
+
+using LaunchHistory = LaunchLog<EspPartitionFlash>;
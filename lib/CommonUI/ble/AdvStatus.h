@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =======================================================
+// Head status broadcast in BBLH advertising data
+//
+// Manufacturer specific AD structure (type 0xFF), 7 bytes of data:
+//
+//   [company u16 LE][tag][flags][battery %][fw][seq]
+//
+// - company: 0xFFFF (reserved for internal / test use)
+// - tag:     0xB0 | version, lets BBLC reject foreign records
+// - fw:      major << 4 | minor
+// - seq:     bumped on every change, lets a scanner skip duplicates
+//
+// Sized so flags + 128-bit service UUID + this record fit the
+// 31-byte primary advertising payload (3 + 18 + 9 = 30).
+// Trade-off: the Appearance field (4 bytes, previously 0x0000
+// "unknown") no longer fits and is not advertised; scanners
+// that sort devices by appearance show BBLH as generic. The
+// name stays in the scan response.
+// Pure header, parsed in place from the raw advertisement.
+// =======================================================
+namespace AdvStatusFormat {
+static constexpr uint16_t COMPANY_ID = 0xFFFF;
+static constexpr uint8_t TAG = 0xB0;
+static constexpr uint8_t VERSION = 1;
+static constexpr uint8_t AD_TYPE_MANUFACTURER = 0xFF;
+static constexpr size_t DATA_SIZE = 7;   // manufacturer data, company included
+static constexpr size_t AD_SIZE = 2 + DATA_SIZE;   // length + type + data
+
+// Primary payload budget: flags AD + complete 128-bit UUID AD + record
+static constexpr size_t ADV_PAYLOAD_MAX = 31;
+static constexpr size_t PRIMARY_USED = 3 + 18 + AD_SIZE;
+static_assert(PRIMARY_USED <= ADV_PAYLOAD_MAX, "status record does not fit the primary advertisement");
+}
+
+namespace AdvStatusFlag {
+static constexpr uint8_t READY          = 1 << 0;   // launcher idle and loaded
+static constexpr uint8_t ARMED          = 1 << 1;   // waiting for FIRE
+static constexpr uint8_t HAS_CONTROLLER = 1 << 2;   // a controller is already paired
+static constexpr uint8_t SLOT_FREE      = 1 << 3;   // accepts another connection
+static constexpr uint8_t FAULT          = 1 << 4;
+}
+
+static constexpr uint8_t ADV_BATTERY_UNKNOWN = 0xFF;
+
+struct AdvStatus {
+    uint8_t flags = 0;
+    uint8_t batteryPct = ADV_BATTERY_UNKNOWN;
+    uint8_t fwMajor = 0;
+    uint8_t fwMinor = 0;
+    uint8_t seq = 0;
+};
+
+inline void encodeAdvStatus(const AdvStatus& s, uint8_t (&out)[AdvStatusFormat::DATA_SIZE]) {
+    out[0] = static_cast<uint8_t>(AdvStatusFormat::COMPANY_ID & 0xFF);
+    out[1] = static_cast<uint8_t>(AdvStatusFormat::COMPANY_ID >> 8);
+    out[2] = AdvStatusFormat::TAG | AdvStatusFormat::VERSION;
+    out[3] = s.flags;
+    out[4] = s.batteryPct;
+    out[5] = static_cast<uint8_t>((s.fwMajor << 4) | (s.fwMinor & 0x0F));
+    out[6] = s.seq;
+}
+
+// Walks the AD structures of a raw advertisement (adv + scan response)
+// without copying. Returns false if no BBLH status record is present.
+inline bool parseAdvStatus(const uint8_t* payload, size_t len, AdvStatus& out) {
+    size_t i = 0;
+    while (i + 1 < len) {
+        const uint8_t fieldLen = payload[i];
+        if (fieldLen == 0 || i + 1 + fieldLen > len) {
+            return false;   // padding or truncated payload
+        }
+
+        const uint8_t type = payload[i + 1];
+        const uint8_t* data = payload + i + 2;
+        const size_t dataLen = fieldLen - 1;
+
+        if (type == AdvStatusFormat::AD_TYPE_MANUFACTURER &&
+            dataLen >= AdvStatusFormat::DATA_SIZE &&
+            data[0] == (AdvStatusFormat::COMPANY_ID & 0xFF) &&
+            data[1] == (AdvStatusFormat::COMPANY_ID >> 8) &&
+            data[2] == (AdvStatusFormat::TAG | AdvStatusFormat::VERSION)) {
+            out.flags = data[3];
+            out.batteryPct = data[4];
+            out.fwMajor = data[5] >> 4;
+            out.fwMinor = data[5] & 0x0F;
+            out.seq = data[6];
+            return true;
+        }
+
+        i += 1 + fieldLen;
+    }
+    return false;
+}
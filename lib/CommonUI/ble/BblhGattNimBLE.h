@@ -0,0 +1,98 @@
+#pragma once
+
+#include <NimBLEDevice.h>
+#include <string.h>
+
+#include "BblhGattSchema.h"
+
+// =======================================================
+// NimBLE glue for the BBLH GATT schema
+//
+// Server: buildServer() creates the service table from
+//         BblhGatt::CHARACTERISTICS.
+// Client: bindClient() discovers the service once and binds
+//         every characteristic handle by schema index.
+// =======================================================
+namespace BblhGatt {
+
+static_assert(ATTR_MAX_LEN == BLE_ATT_ATTR_MAX_LEN, "schema and NimBLE disagree on the attribute size");
+
+inline NimBLEUUID toNimUuid(const Uuid128& uuid) {
+    ble_uuid128_t raw;
+    raw.u.type = BLE_UUID_TYPE_128;
+    memcpy(raw.value, uuid.bytes, sizeof(raw.value));
+    return NimBLEUUID(&raw);
+}
+
+// Built once on first use (memcpy, no string parsing)
+inline const NimBLEUUID& serviceUuid() {
+    static const NimBLEUUID uuid = toNimUuid(SERVICE_UUID);
+    return uuid;
+}
+
+inline uint32_t toNimProperties(uint8_t props) {
+    uint32_t out = 0;
+    if (props & Prop::READ)     out |= NIMBLE_PROPERTY::READ;
+    if (props & Prop::WRITE)    out |= NIMBLE_PROPERTY::WRITE;
+    if (props & Prop::WRITE_NR) out |= NIMBLE_PROPERTY::WRITE_NR;
+    if (props & Prop::NOTIFY)   out |= NIMBLE_PROPERTY::NOTIFY;
+    if (props & Prop::INDICATE) out |= NIMBLE_PROPERTY::INDICATE;
+    return out;
+}
+
+// =========================
+// Server side
+// =========================
+inline NimBLEService* buildServer(NimBLEServer* server, NimBLECharacteristic* (&chars)[CHAR_COUNT]) {
+    NimBLEService* service = server->createService(serviceUuid());
+
+    for (size_t i = 0; i < CHAR_COUNT; ++i) {
+        const CharDef& def = CHARACTERISTICS[i];
+        chars[i] = service->createCharacteristic(toNimUuid(def.uuid), toNimProperties(def.props));
+    }
+
+    return service;
+}
+
+// =========================
+// Client side
+// =========================
+// Returns the remote service, or nullptr if it or a required
+// characteristic is missing. Unbound optional entries stay nullptr.
+inline NimBLERemoteService* bindClient(NimBLEClient* client,
+                                       NimBLERemoteCharacteristic* (&chars)[CHAR_COUNT]) {
+    for (auto& chr : chars) {
+        chr = nullptr;
+    }
+
+    NimBLERemoteService* service = client ? client->getService(serviceUuid()) : nullptr;
+    if (!service) {
+        return nullptr;
+    }
+
+    // One discovery for the whole service, then match locally
+    for (NimBLERemoteCharacteristic* chr : service->getCharacteristics(true)) {
+        const ble_uuid_t* base = chr->getUUID().getBase();
+        if (!base || base->type != BLE_UUID_TYPE_128) {
+            continue;
+        }
+        const uint8_t* value = reinterpret_cast<const ble_uuid128_t*>(base)->value;
+
+        for (size_t i = 0; i < CHAR_COUNT; ++i) {
+            if (memcmp(value, CHARACTERISTICS[i].uuid.bytes, 16) == 0) {
+                chars[i] = chr;
+                break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < CHAR_COUNT; ++i) {
+        if (CHARACTERISTICS[i].required && !chars[i]) {
+            return nullptr;
+        }
+    }
+
+    return service;
+}
+
+} // namespace BblhGatt
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =======================================================
+// BBLH GATT schema - single source of truth
+//
+// Declarative description of the BBLH service shared by the
+// server (BleServerBBLH builds its table from it) and the client
+// (BleClientBBLC binds its handles from it). UUIDs are parsed at
+// compile time into 128-bit constants, nothing runs at static init.
+//
+// Pure header: no NimBLE dependency, see BblhGattNimBLE.h for
+// the glue.
+// =======================================================
+namespace BblhGatt {
+
+// 128-bit UUID, little-endian (same byte order as ble_uuid128_t)
+struct Uuid128 {
+    uint8_t bytes[16];
+};
+
+constexpr uint8_t hexNibble(char c) {
+    return (c >= '0' && c <= '9') ? static_cast<uint8_t>(c - '0')
+         : (c >= 'a' && c <= 'f') ? static_cast<uint8_t>(c - 'a' + 10)
+         : (c >= 'A' && c <= 'F') ? static_cast<uint8_t>(c - 'A' + 10)
+         : 0xFF;
+}
+
+// "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx" -> Uuid128
+constexpr Uuid128 uuid128(const char (&text)[37]) {
+    Uuid128 u {};
+    int out = 15;
+    for (int i = 0; i < 36;) {
+        if (text[i] == '-') {
+            ++i;
+            continue;
+        }
+        u.bytes[out--] = static_cast<uint8_t>((hexNibble(text[i]) << 4) | hexNibble(text[i + 1]));
+        i += 2;
+    }
+    return u;
+}
+
+constexpr bool operator==(const Uuid128& a, const Uuid128& b) {
+    for (int i = 0; i < 16; ++i) {
+        if (a.bytes[i] != b.bytes[i]) return false;
+    }
+    return true;
+}
+
+// =========================
+// Schema types
+// =========================
+namespace Prop {
+    static constexpr uint8_t READ     = 1 << 0;
+    static constexpr uint8_t WRITE    = 1 << 1;
+    static constexpr uint8_t WRITE_NR = 1 << 2;
+    static constexpr uint8_t NOTIFY   = 1 << 3;
+    static constexpr uint8_t INDICATE = 1 << 4;
+}
+
+enum class CharId : uint8_t {
+    CMD,
+    STATUS,
+    LOG,
+    COUNT
+};
+
+static constexpr size_t CHAR_COUNT = static_cast<size_t>(CharId::COUNT);
+
+struct CharDef {
+    CharId id;
+    Uuid128 uuid;
+    uint8_t props;
+    bool required;   // client fails setup when missing
+};
+
+// =========================
+// The BBLH service
+// =========================
+static constexpr Uuid128 SERVICE_UUID = uuid128("a1b2c3d4-0001-4000-8000-000000000001");
+
+static constexpr CharDef CHARACTERISTICS[] = {
+    // CMD: client -> server, BleProto frames
+    {CharId::CMD,    uuid128("a1b2c3d4-0002-4000-8000-000000000001"),
+     Prop::WRITE | Prop::WRITE_NR, true},
+
+    // STATUS: server -> client, legacy ASCII status or BleProto frames
+    {CharId::STATUS, uuid128("a1b2c3d4-0003-4000-8000-000000000001"),
+     Prop::READ | Prop::NOTIFY,    true},
+
+    // LOG: launch history batches, server -> client (optional on older heads)
+    {CharId::LOG,    uuid128("a1b2c3d4-0004-4000-8000-000000000001"),
+     Prop::READ | Prop::NOTIFY,    false},
+};
+
+constexpr const CharDef& charDef(CharId id) {
+    return CHARACTERISTICS[static_cast<size_t>(id)];
+}
+
+// =========================
+// Frame size limits
+// =========================
+// Value bytes of one write / notify at the default 23-byte ATT MTU:
+// control frames must fit before (or without) the MTU exchange
+static constexpr size_t DEFAULT_MTU_PAYLOAD = 20;
+
+// Largest attribute value (NimBLE's BLE_ATT_ATTR_MAX_LEN)
+static constexpr size_t ATTR_MAX_LEN = 512;
+
+// Queued STATUS replies (bench and boot reports) wait in the BBLH notify
+// scheduler, whose slots hold this many bytes
+static constexpr size_t STATUS_FRAME_MAX = 64;
+
+// =========================
+// Compile-time consistency checks
+// =========================
+namespace detail {
+
+constexpr bool tableIndexedById() {
+    for (size_t i = 0; i < CHAR_COUNT; ++i) {
+        if (static_cast<size_t>(CHARACTERISTICS[i].id) != i) return false;
+    }
+    return true;
+}
+
+constexpr bool uuidsUnique() {
+    for (size_t i = 0; i < CHAR_COUNT; ++i) {
+        if (CHARACTERISTICS[i].uuid == SERVICE_UUID) return false;
+        for (size_t j = i + 1; j < CHAR_COUNT; ++j) {
+            if (CHARACTERISTICS[i].uuid == CHARACTERISTICS[j].uuid) return false;
+        }
+    }
+    return true;
+}
+
+// Characteristics only differ from the service UUID in bytes 10..11
+// (the "xxxx" field after the first dash).
+constexpr bool sharesServiceBase(const Uuid128& u) {
+    for (int i = 0; i < 16; ++i) {
+        if (i == 10 || i == 11) continue;
+        if (u.bytes[i] != SERVICE_UUID.bytes[i]) return false;
+    }
+    return true;
+}
+
+constexpr bool allShareServiceBase() {
+    for (size_t i = 0; i < CHAR_COUNT; ++i) {
+        if (!sharesServiceBase(CHARACTERISTICS[i].uuid)) return false;
+    }
+    return true;
+}
+
+} // namespace detail
+
+static_assert(sizeof(CHARACTERISTICS) / sizeof(CHARACTERISTICS[0]) == CHAR_COUNT,
+              "CHARACTERISTICS must list every CharId");
+static_assert(detail::tableIndexedById(), "CHARACTERISTICS must be ordered by CharId");
+static_assert(detail::uuidsUnique(), "duplicate UUID in BBLH schema");
+static_assert(detail::allShareServiceBase(), "characteristic UUID outside the BBLH base");
+static_assert(SERVICE_UUID.bytes[15] == 0xa1 && SERVICE_UUID.bytes[0] == 0x01,
+              "UUID must be stored little-endian");
+
+} // namespace BblhGatt
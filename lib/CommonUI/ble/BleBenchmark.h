@@ -0,0 +1,269 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "BleProtocol.h"
+
+// =======================================================
+// Throughput benchmark between BBLC and BBLH
+//
+// Transport agnostic: the firmwares plug it on CMD writes /
+// STATUS notifications, a host build can plug it on Loopback.
+//
+//   BENCH_START  [op][config (10 bytes)]          BBLC -> BBLH
+//   BENCH_DATA   [op][seq u32][filler...]          either way
+//   BENCH_STOP   [op]                              BBLC -> BBLH
+//   BENCH_REPORT [op][Report (REPORT_SIZE bytes)]  BBLH -> BBLC
+//
+// All multi-byte fields are little-endian (BleProto helpers).
+//
+// The ATT MTU is not part of the config: it is exchanged once
+// per connection, so a run always uses the MTU of the live link
+// (reported as effectiveMtu).
+// =======================================================
+namespace BleBench {
+
+using BleProto::getU16;
+using BleProto::getU32;
+using BleProto::putU16;
+using BleProto::putU32;
+
+static constexpr uint8_t REPORT_VERSION = 1;
+static constexpr size_t DATA_HEADER_SIZE = 5;     // op + seq
+static constexpr size_t CONFIG_SIZE = 10;
+static constexpr size_t REPORT_SIZE = 46;
+
+enum class Direction : uint8_t {
+    WRITE = 0,    // BBLC floods CMD writes
+    NOTIFY = 1,   // BBLH floods STATUS notifications
+};
+
+enum class WriteType : uint8_t {
+    NO_RESPONSE = 0,
+    WITH_RESPONSE = 1,
+};
+
+enum class Role : uint8_t {
+    CLIENT = 0,
+    SERVER = 1,
+};
+
+struct Config {
+    Direction direction = Direction::WRITE;
+    WriteType writeType = WriteType::NO_RESPONSE;
+    uint8_t phy = 1;               // 1 = 1M, 2 = 2M, 3 = coded
+    uint16_t payloadSize = 20;     // bytes per operation, header included
+    uint16_t durationMs = 3000;
+};
+
+struct Stats {
+    // Sender side
+    uint32_t opsOk = 0;
+    uint32_t opsFailed = 0;
+    uint32_t bytesSent = 0;
+    uint32_t cpuUs = 0;            // time spent inside the send calls
+    uint32_t elapsedMs = 0;
+
+    // Receiver side
+    uint32_t rxFrames = 0;
+    uint32_t rxBytes = 0;
+    uint32_t rxLost = 0;           // sequence gaps (dropped frames)
+
+    uint32_t goodputBps() const {
+        const uint32_t bytes = rxBytes ? rxBytes : bytesSent;
+        return elapsedMs ? static_cast<uint32_t>((static_cast<uint64_t>(bytes) * 1000u) / elapsedMs) : 0;
+    }
+};
+
+struct Report {
+    uint8_t version = REPORT_VERSION;
+    Role role = Role::CLIENT;
+    uint16_t effectiveMtu = 0;
+    Config config;
+    Stats stats;
+};
+
+// =========================
+// Config / Report codecs
+// =========================
+inline void encodeConfig(const Config& c, uint8_t* out) {
+    out[0] = static_cast<uint8_t>(c.direction);
+    out[1] = static_cast<uint8_t>(c.writeType);
+    out[2] = c.phy;
+    out[3] = 0;   // reserved
+    putU16(out + 4, c.payloadSize);
+    putU16(out + 6, 0);   // reserved (was the requested MTU)
+    putU16(out + 8, c.durationMs);
+}
+
+inline bool decodeConfig(const uint8_t* in, size_t len, Config& c) {
+    if (len < CONFIG_SIZE) return false;
+    c.direction = static_cast<Direction>(in[0]);
+    c.writeType = static_cast<WriteType>(in[1]);
+    c.phy = in[2];
+    c.payloadSize = getU16(in + 4);
+    c.durationMs = getU16(in + 8);
+    return c.payloadSize >= DATA_HEADER_SIZE;
+}
+
+inline void encodeReport(const Report& r, uint8_t* out) {
+    out[0] = r.version;
+    out[1] = static_cast<uint8_t>(r.role);
+    putU16(out + 2, r.effectiveMtu);
+    encodeConfig(r.config, out + 4);
+    const Stats& s = r.stats;
+    putU32(out + 14, s.opsOk);
+    putU32(out + 18, s.opsFailed);
+    putU32(out + 22, s.bytesSent);
+    putU32(out + 26, s.cpuUs);
+    putU32(out + 30, s.elapsedMs);
+    putU32(out + 34, s.rxFrames);
+    putU32(out + 38, s.rxBytes);
+    putU32(out + 42, s.rxLost);
+}
+
+inline bool decodeReport(const uint8_t* in, size_t len, Report& r) {
+    if (len < REPORT_SIZE || in[0] != REPORT_VERSION) return false;
+    r.version = in[0];
+    r.role = static_cast<Role>(in[1]);
+    r.effectiveMtu = getU16(in + 2);
+    decodeConfig(in + 4, CONFIG_SIZE, r.config);
+    Stats& s = r.stats;
+    s.opsOk = getU32(in + 14);
+    s.opsFailed = getU32(in + 18);
+    s.bytesSent = getU32(in + 22);
+    s.cpuUs = getU32(in + 26);
+    s.elapsedMs = getU32(in + 30);
+    s.rxFrames = getU32(in + 34);
+    s.rxBytes = getU32(in + 38);
+    s.rxLost = getU32(in + 42);
+    return true;
+}
+
+// =========================
+// Session: one side of a run
+// =========================
+class Session {
+public:
+    void start(const Config& config, uint32_t nowMs, uint16_t maxPayload) {
+        config_ = config;
+        if (config_.payloadSize > maxPayload) config_.payloadSize = maxPayload;
+        if (config_.payloadSize < DATA_HEADER_SIZE) config_.payloadSize = DATA_HEADER_SIZE;
+        stats_ = Stats();
+        startMs_ = nowMs;
+        txSeq_ = 0;
+        rxNextSeq_ = 0;
+        running_ = true;
+    }
+
+    void stop(uint32_t nowMs) {
+        if (!running_) return;
+        stats_.elapsedMs = nowMs - startMs_;
+        running_ = false;
+    }
+
+    bool running() const { return running_; }
+
+    // True while the sender should keep flooding.
+    bool sending(uint32_t nowMs) const {
+        return running_ && (nowMs - startMs_) < config_.durationMs;
+    }
+
+    // Still running well past its duration (peer never sent STOP).
+    bool overdue(uint32_t nowMs, uint32_t graceMs) const {
+        return running_ && (nowMs - startMs_) >= config_.durationMs + graceMs;
+    }
+
+    // Builds the next BENCH_DATA frame, returns its size.
+    size_t nextFrame(uint8_t* out) {
+        out[0] = static_cast<uint8_t>(BleProto::Op::BENCH_DATA);
+        putU32(out + 1, txSeq_++);
+        memset(out + DATA_HEADER_SIZE, 0xA5, config_.payloadSize - DATA_HEADER_SIZE);
+        return config_.payloadSize;
+    }
+
+    void recordSend(bool ok, size_t len, uint32_t cpuUs) {
+        if (ok) {
+            ++stats_.opsOk;
+            stats_.bytesSent += len;
+        } else {
+            ++stats_.opsFailed;
+            --txSeq_;   // never left the device: not a loss for the receiver
+        }
+        stats_.cpuUs += cpuUs;
+    }
+
+    void onFrame(const uint8_t* data, size_t len) {
+        if (len < DATA_HEADER_SIZE) return;
+        const uint32_t seq = getU32(data + 1);
+        if (seq > rxNextSeq_) stats_.rxLost += seq - rxNextSeq_;
+        rxNextSeq_ = seq + 1;
+        ++stats_.rxFrames;
+        stats_.rxBytes += len;
+    }
+
+    Report report(Role role, uint16_t effectiveMtu) const {
+        Report r;
+        r.role = role;
+        r.effectiveMtu = effectiveMtu;
+        r.config = config_;
+        r.stats = stats_;
+        return r;
+    }
+
+    const Config& config() const { return config_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    Config config_;
+    Stats stats_;
+    uint32_t startMs_ = 0;
+    uint32_t txSeq_ = 0;
+    uint32_t rxNextSeq_ = 0;
+    bool running_ = false;
+};
+
+// =========================
+// In-process loopback link (host builds)
+// =========================
+// Bounded FIFO between a sender Session and a receiver Session,
+// dropping frames when full like a saturated controller buffer.
+template<size_t DEPTH = 16, size_t MAX_FRAME = 256>
+class Loopback {
+public:
+    bool send(const uint8_t* data, size_t len) {
+        if (count_ == DEPTH || len > MAX_FRAME) return false;
+        Slot& s = slots_[(head_ + count_) % DEPTH];
+        memcpy(s.data, data, len);
+        s.len = len;
+        ++count_;
+        return true;
+    }
+
+    // Delivers up to `budget` frames to the receiver session.
+    size_t deliver(Session& receiver, size_t budget) {
+        size_t n = 0;
+        while (count_ > 0 && n < budget) {
+            const Slot& s = slots_[head_];
+            receiver.onFrame(s.data, s.len);
+            head_ = (head_ + 1) % DEPTH;
+            --count_;
+            ++n;
+        }
+        return n;
+    }
+
+private:
+    struct Slot {
+        uint8_t data[MAX_FRAME];
+        size_t len;
+    };
+
+    Slot slots_[DEPTH];
+    size_t head_ = 0;
+    size_t count_ = 0;
+};
+
+} // namespace BleBench
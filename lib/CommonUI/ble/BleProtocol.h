@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =======================================================
+// Binary frames exchanged on CMD (BBLC -> BBLH) and
+// STATUS (BBLH -> BBLC).
+//
+// Byte 0 is the opcode. Opcodes stay below 0x20 so that the
+// legacy ASCII status strings ("READY", "CMD_RX") can still be
+// told apart from binary frames on the STATUS characteristic.
+// =======================================================
+namespace BleProto {
+
+enum class Op : uint8_t {
+    FIRE    = 0x01,   // [op][profile], or the gesture form below
+    HELLO   = 0x02,   // [op][PeerRole] - sent by a central right after connecting
+    LOG_EXPORT = 0x08,   // [op][from seq u32 LE] - stream launch history on LOG
+    BOOT_REPORT = 0x09,  // [op] request, reply [op][BootTimeline payload] on STATUS
+    LINK_TX = 0x10,   // [op][int8 tx power dBm] - sender's current TX power
+
+    // Throughput benchmark, see BleBenchmark.h
+    BENCH_START  = 0x18,
+    BENCH_STOP   = 0x19,
+    BENCH_DATA   = 0x1A,
+    BENCH_REPORT = 0x1B,
+};
+
+// FIRE triggered by a motion gesture (BBLC rip):
+// [op][profile][strength 0..255][gesture age us u32 LE]
+// The two clocks are not shared, so the gesture time travels as its
+// age when the frame is written: the head gets gesture -> fire latency
+// as age + (its own receive -> fire time), radio time excluded.
+static constexpr size_t FIRE_FRAME_LEN = 2;
+static constexpr size_t FIRE_GESTURE_FRAME_LEN = 7;
+
+// LOG characteristic batch: [flags][count][count * LaunchRecord]
+static constexpr size_t LOG_BATCH_HEADER = 2;
+static constexpr uint8_t LOG_BATCH_LAST = 0x01;   // export complete after this batch
+
+inline bool isBinaryFrame(const uint8_t* data, size_t len) {
+    return data && len > 0 && data[0] < 0x20;
+}
+
+// =========================
+// Little-endian helpers (all multi-byte frame fields)
+// =========================
+inline void putU16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline void putU32(uint8_t* p, uint32_t v) {
+    putU16(p, static_cast<uint16_t>(v));
+    putU16(p + 2, static_cast<uint16_t>(v >> 16));
+}
+
+inline uint16_t getU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t getU32(const uint8_t* p) {
+    return static_cast<uint32_t>(getU16(p)) | (static_cast<uint32_t>(getU16(p + 2)) << 16);
+}
+
+} // namespace BleProto
@@ -0,0 +1,456 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+
+// =======================================================
+// BLE connection state machine, one transition table per role
+//
+// Tables are built at compile time from a list of transitions and
+// a per-state timeout definition. Dispatch is a single array lookup,
+// anything not in the table is rejected and counted. Time spent in
+// each state and before each transition is recorded.
+//
+// Pure header: time is passed in by the caller, no Arduino dependency.
+// The machine itself is single threaded: events raised on the NimBLE
+// host task go through a BleEventQueue and are dispatched from loop().
+// =======================================================
+
+// Shared BLE state for Client (BBLC) and Server (BBLH)
+enum class BleState : uint8_t {
+    // Common
+    BOOT,
+
+    // -------- Client BLE (BBLC) --------
+    SCANNING,        // Client scanning for server
+    CONNECTING,
+    CONNECTED,       // Client linked to a head / server has at least one client
+
+    // -------- Server BLE (BBLH) --------
+    ADVERTISING,     // Server advertising
+
+    // -------- Common --------
+    DISCONNECTED,
+    ERROR,
+
+    COUNT
+};
+
+static constexpr size_t BLE_STATE_COUNT = static_cast<size_t>(BleState::COUNT);
+
+/**
+ * @brief Convert a BleState enum to a human-readable string.
+ *
+ * This function is declared `inline` because it is defined in a header file
+ * that is included by multiple translation units (e.g. main.cpp,
+ * BleClientBBLC.cpp).
+ *
+ * Without `inline`, each .cpp file including this header would generate its
+ * own definition of the function, leading to a "multiple definition" linker
+ * error.
+ *
+ * Declaring the function `inline` allows the linker to accept multiple
+ * identical definitions, as required by the C++ One Definition Rule (ODR),
+ * while still keeping the implementation in the header for convenience.
+ *
+ * @param state Current BLE client state.
+ * @return A constant string representing the state.
+ */
+
+inline const char* bleStateToString(BleState state) {
+    switch (state) {
+        case BleState::BOOT:         return "BOOT";
+        case BleState::SCANNING:     return "SCANNING";
+        case BleState::CONNECTING:   return "CONNECTING";
+        case BleState::CONNECTED:    return "CONNECTED";
+        case BleState::ADVERTISING:  return "ADVERTISING";
+        case BleState::DISCONNECTED: return "DISCONNECTED";
+        case BleState::ERROR:        return "ERROR";
+        default:                     return "UNKNOWN";
+    }
+}
+
+enum class BleEvent : uint8_t {
+    START,          // start (or restart) scanning / advertising
+    PEER_FOUND,     // client: target head selected, connect
+    LINK_UP,        // link established and usable
+    LINK_FAILED,    // connection attempt failed, or no head may be tried yet
+    FAULT,          // GATT setup / advertising failure
+    LINK_LOST,      // last link dropped
+    TIMEOUT,        // raised by poll() when a state outlives its budget
+    COUNT
+};
+
+static constexpr size_t BLE_EVENT_COUNT = static_cast<size_t>(BleEvent::COUNT);
+
+inline const char* bleEventToString(BleEvent event) {
+    switch (event) {
+        case BleEvent::START:       return "START";
+        case BleEvent::PEER_FOUND:  return "PEER_FOUND";
+        case BleEvent::LINK_UP:     return "LINK_UP";
+        case BleEvent::LINK_FAILED: return "LINK_FAILED";
+        case BleEvent::FAULT:       return "FAULT";
+        case BleEvent::LINK_LOST:   return "LINK_LOST";
+        case BleEvent::TIMEOUT:     return "TIMEOUT";
+        default:                    return "UNKNOWN";
+    }
+}
+
+// =========================
+// Table types
+// =========================
+struct BleStateDef {
+    uint32_t timeoutMs;    // 0 = no timeout
+    BleState onTimeout;    // recovery state when the timeout fires
+};
+
+struct BleTransition {
+    BleState from;
+    BleEvent event;
+    BleState to;
+};
+
+struct BleRoleTable {
+    const char* name;
+    BleStateDef states[BLE_STATE_COUNT];
+    BleState next[BLE_STATE_COUNT][BLE_EVENT_COUNT];   // BleState::COUNT = illegal
+};
+
+namespace BleStateDetail {
+
+constexpr size_t idx(BleState s) { return static_cast<size_t>(s); }
+constexpr size_t idx(BleEvent e) { return static_cast<size_t>(e); }
+
+} // namespace BleStateDetail
+
+// Timeout edges come from the state definitions, not the transition list.
+template<size_t N>
+constexpr BleRoleTable makeBleRoleTable(const char* name,
+                                        const BleStateDef (&states)[BLE_STATE_COUNT],
+                                        const BleTransition (&transitions)[N]) {
+    BleRoleTable t {};
+    t.name = name;
+
+    for (size_t s = 0; s < BLE_STATE_COUNT; ++s) {
+        t.states[s] = states[s];
+        for (size_t e = 0; e < BLE_EVENT_COUNT; ++e) {
+            t.next[s][e] = BleState::COUNT;
+        }
+        if (states[s].timeoutMs) {
+            t.next[s][BleStateDetail::idx(BleEvent::TIMEOUT)] = states[s].onTimeout;
+        }
+    }
+
+    for (size_t i = 0; i < N; ++i) {
+        t.next[BleStateDetail::idx(transitions[i].from)][BleStateDetail::idx(transitions[i].event)] = transitions[i].to;
+    }
+    return t;
+}
+
+// =========================
+// Compile-time graph checks
+// =========================
+namespace BleStateDetail {
+
+template<size_t N>
+constexpr bool transitionsWellFormed(const BleTransition (&transitions)[N]) {
+    for (size_t i = 0; i < N; ++i) {
+        if (transitions[i].event == BleEvent::TIMEOUT) return false;   // use BleStateDef
+        for (size_t j = i + 1; j < N; ++j) {
+            if (transitions[i].from == transitions[j].from &&
+                transitions[i].event == transitions[j].event) {
+                return false;   // ambiguous
+            }
+        }
+    }
+    return true;
+}
+
+constexpr bool hasExit(const BleRoleTable& t, size_t s) {
+    for (size_t e = 0; e < BLE_EVENT_COUNT; ++e) {
+        if (t.next[s][e] != BleState::COUNT && t.next[s][e] != static_cast<BleState>(s)) return true;
+    }
+    return false;
+}
+
+// Every state reachable from BOOT can be left again (no dead end).
+constexpr bool noDeadEnd(const BleRoleTable& t) {
+    bool reached[BLE_STATE_COUNT] = {};
+    reached[idx(BleState::BOOT)] = true;
+
+    for (size_t pass = 0; pass < BLE_STATE_COUNT; ++pass) {
+        for (size_t s = 0; s < BLE_STATE_COUNT; ++s) {
+            if (!reached[s]) continue;
+            for (size_t e = 0; e < BLE_EVENT_COUNT; ++e) {
+                if (t.next[s][e] != BleState::COUNT) reached[idx(t.next[s][e])] = true;
+            }
+        }
+    }
+
+    for (size_t s = 0; s < BLE_STATE_COUNT; ++s) {
+        if (reached[s] && !hasExit(t, s)) return false;
+    }
+    return true;
+}
+
+} // namespace BleStateDetail
+
+// =========================
+// Role tables
+// =========================
+namespace BleRole {
+
+// ---- BBLC (central) ----
+static constexpr BleStateDef CLIENT_STATES[BLE_STATE_COUNT] = {
+    /* BOOT         */ {0,     BleState::BOOT},
+    /* SCANNING     */ {0,     BleState::SCANNING},
+    /* CONNECTING   */ {10000, BleState::ERROR},      // also the stack connect timeout
+    /* CONNECTED    */ {0,     BleState::CONNECTED},
+    /* ADVERTISING  */ {0,     BleState::ADVERTISING},
+    /* DISCONNECTED */ {250,   BleState::SCANNING},   // rescan from loop(), not the host callback
+    /* ERROR        */ {2000,  BleState::SCANNING},   // keep the error visible, then retry
+};
+
+static constexpr BleTransition CLIENT_TRANSITIONS[] = {
+    {BleState::BOOT,         BleEvent::START,       BleState::SCANNING},
+    {BleState::SCANNING,     BleEvent::START,       BleState::SCANNING},
+    {BleState::SCANNING,     BleEvent::PEER_FOUND,  BleState::CONNECTING},
+    {BleState::SCANNING,     BleEvent::LINK_FAILED, BleState::DISCONNECTED},   // only blocked heads: back off
+    {BleState::CONNECTING,   BleEvent::LINK_UP,     BleState::CONNECTED},
+    {BleState::CONNECTING,   BleEvent::LINK_FAILED, BleState::DISCONNECTED},
+    {BleState::CONNECTING,   BleEvent::FAULT,       BleState::ERROR},
+    {BleState::CONNECTING,   BleEvent::LINK_LOST,   BleState::DISCONNECTED},
+    {BleState::CONNECTED,    BleEvent::LINK_LOST,   BleState::DISCONNECTED},
+    {BleState::DISCONNECTED, BleEvent::START,       BleState::SCANNING},
+    {BleState::ERROR,        BleEvent::START,       BleState::SCANNING},
+};
+
+static constexpr BleRoleTable CLIENT = makeBleRoleTable("client", CLIENT_STATES, CLIENT_TRANSITIONS);
+
+// ---- BBLH (peripheral) ----
+static constexpr BleStateDef SERVER_STATES[BLE_STATE_COUNT] = {
+    /* BOOT         */ {0,    BleState::BOOT},
+    /* SCANNING     */ {0,    BleState::SCANNING},
+    /* CONNECTING   */ {0,    BleState::CONNECTING},
+    /* CONNECTED    */ {0,    BleState::CONNECTED},
+    /* ADVERTISING  */ {0,    BleState::ADVERTISING},
+    /* DISCONNECTED */ {250,  BleState::ADVERTISING},
+    /* ERROR        */ {2000, BleState::ADVERTISING},
+};
+
+static constexpr BleTransition SERVER_TRANSITIONS[] = {
+    {BleState::BOOT,         BleEvent::START,     BleState::ADVERTISING},
+    {BleState::BOOT,         BleEvent::FAULT,     BleState::ERROR},
+    {BleState::ADVERTISING,  BleEvent::START,     BleState::ADVERTISING},
+    {BleState::ADVERTISING,  BleEvent::LINK_UP,   BleState::CONNECTED},
+    {BleState::ADVERTISING,  BleEvent::FAULT,     BleState::ERROR},
+    {BleState::CONNECTED,    BleEvent::LINK_LOST, BleState::DISCONNECTED},
+    {BleState::DISCONNECTED, BleEvent::START,     BleState::ADVERTISING},
+    {BleState::DISCONNECTED, BleEvent::LINK_UP,   BleState::CONNECTED},   // advertising still on
+    {BleState::ERROR,        BleEvent::START,     BleState::ADVERTISING},
+};
+
+static constexpr BleRoleTable SERVER = makeBleRoleTable("server", SERVER_STATES, SERVER_TRANSITIONS);
+
+static_assert(BleStateDetail::transitionsWellFormed(CLIENT_TRANSITIONS), "client table: duplicate or TIMEOUT entry");
+static_assert(BleStateDetail::transitionsWellFormed(SERVER_TRANSITIONS), "server table: duplicate or TIMEOUT entry");
+static_assert(BleStateDetail::noDeadEnd(CLIENT), "client table: reachable state without exit");
+static_assert(BleStateDetail::noDeadEnd(SERVER), "server table: reachable state without exit");
+
+} // namespace BleRole
+
+// =========================
+// Statistics
+// =========================
+struct BleDwellStats {
+    uint32_t count = 0;
+    uint32_t totalMs = 0;
+    uint32_t maxMs = 0;
+
+    void add(uint32_t ms) {
+        ++count;
+        totalMs += ms;
+        if (ms > maxMs) maxMs = ms;
+    }
+
+    uint32_t avgMs() const { return count ? totalMs / count : 0; }
+};
+
+// =========================
+// BleStateMachine
+// =========================
+class BleStateMachine {
+public:
+    using TransitionCallback = std::function<void(BleState from, BleState to, BleEvent event)>;
+
+    explicit BleStateMachine(const BleRoleTable& table) : table_(table) {}
+
+    void begin(uint32_t nowMs) {
+        state_ = BleState::BOOT;
+        enteredMs_ = nowMs;
+        visitTimeoutMs_ = timeoutMs(state_);
+        for (size_t s = 0; s < BLE_STATE_COUNT; ++s) {
+            stateStats_[s] = BleDwellStats();
+            for (size_t e = 0; e < BLE_EVENT_COUNT; ++e) edgeStats_[s][e] = BleDwellStats();
+        }
+        rejected_ = 0;
+    }
+
+    // Called after the state changed (self transitions included).
+    void onTransition(TransitionCallback cb) { transitionCb_ = cb; }
+
+    BleState state() const { return state_; }
+    const BleRoleTable& table() const { return table_; }
+
+    bool accepts(BleEvent event) const { return target(event) != BleState::COUNT; }
+
+    // Returns false, without side effects, when the table has no such edge.
+    bool dispatch(BleEvent event, uint32_t nowMs) {
+        const BleState to = target(event);
+        if (to == BleState::COUNT) {
+            ++rejected_;
+            lastRejectedState_ = state_;
+            lastRejectedEvent_ = event;
+            return false;
+        }
+
+        const BleState from = state_;
+        const uint32_t dwell = nowMs - enteredMs_;
+        stateStats_[BleStateDetail::idx(from)].add(dwell);
+        edgeStats_[BleStateDetail::idx(from)][BleStateDetail::idx(event)].add(dwell);
+
+        state_ = to;
+        enteredMs_ = nowMs;
+        visitTimeoutMs_ = timeoutMs(to);
+
+        if (transitionCb_) transitionCb_(from, to, event);
+        return true;
+    }
+
+    // Fires TIMEOUT once the current state outlived its budget.
+    bool poll(uint32_t nowMs) {
+        const uint32_t timeout = visitTimeoutMs_;
+        if (!timeout || nowMs - enteredMs_ < timeout) return false;
+        return dispatch(BleEvent::TIMEOUT, nowMs);
+    }
+
+    uint32_t timeoutMs(BleState s) const { return table_.states[BleStateDetail::idx(s)].timeoutMs; }
+
+    // Replaces the table timeout for the current visit only (e.g. a
+    // reconnect backoff in DISCONNECTED), typically from the transition
+    // callback. Ignored in states without a timeout: they have no TIMEOUT
+    // edge. 0 is raised to 1 ms, it would otherwise disable the timeout.
+    bool setStateTimeout(uint32_t ms) {
+        if (!timeoutMs(state_)) return false;
+        visitTimeoutMs_ = ms ? ms : 1;
+        return true;
+    }
+
+    // Time left before poll() fires, UINT32_MAX when the state has no timeout.
+    uint32_t msUntilTimeout(uint32_t nowMs) const {
+        const uint32_t timeout = visitTimeoutMs_;
+        if (!timeout) return UINT32_MAX;
+        const uint32_t elapsed = nowMs - enteredMs_;
+        return elapsed >= timeout ? 0 : timeout - elapsed;
+    }
+
+    uint32_t timeInStateMs(uint32_t nowMs) const { return nowMs - enteredMs_; }
+
+    // Completed visits only (the current one is timeInStateMs()).
+    const BleDwellStats& stateStats(BleState s) const { return stateStats_[BleStateDetail::idx(s)]; }
+    // Dwell in `from` before leaving it through `event`.
+    const BleDwellStats& edgeStats(BleState from, BleEvent event) const {
+        return edgeStats_[BleStateDetail::idx(from)][BleStateDetail::idx(event)];
+    }
+
+    template<typename Fn>
+    void forEachVisitedState(Fn fn) const {
+        for (size_t s = 0; s < BLE_STATE_COUNT; ++s) {
+            if (stateStats_[s].count) fn(static_cast<BleState>(s), stateStats_[s]);
+        }
+    }
+
+    // fn(from, event, to, dwell) for every edge taken at least once
+    template<typename Fn>
+    void forEachTakenEdge(Fn fn) const {
+        for (size_t s = 0; s < BLE_STATE_COUNT; ++s) {
+            for (size_t e = 0; e < BLE_EVENT_COUNT; ++e) {
+                if (edgeStats_[s][e].count) {
+                    fn(static_cast<BleState>(s), static_cast<BleEvent>(e), table_.next[s][e], edgeStats_[s][e]);
+                }
+            }
+        }
+    }
+
+    uint32_t rejectedCount() const { return rejected_; }
+    BleState lastRejectedState() const { return lastRejectedState_; }
+    BleEvent lastRejectedEvent() const { return lastRejectedEvent_; }
+
+private:
+    BleState target(BleEvent event) const {
+        const size_t e = BleStateDetail::idx(event);
+        return e < BLE_EVENT_COUNT ? table_.next[BleStateDetail::idx(state_)][e] : BleState::COUNT;
+    }
+
+    const BleRoleTable& table_;
+    BleState state_ = BleState::BOOT;
+    uint32_t enteredMs_ = 0;
+    uint32_t visitTimeoutMs_ = 0;
+    TransitionCallback transitionCb_;
+
+    BleDwellStats stateStats_[BLE_STATE_COUNT];
+    BleDwellStats edgeStats_[BLE_STATE_COUNT][BLE_EVENT_COUNT];
+    uint32_t rejected_ = 0;
+    BleState lastRejectedState_ = BleState::BOOT;
+    BleEvent lastRejectedEvent_ = BleEvent::START;
+};
+
+// =========================
+// BleEventQueue
+// =========================
+// Hands events from the NimBLE host task (connect / disconnect callbacks)
+// to the task that owns the state machine. One producer, one consumer:
+// each index is written by one side only, so no lock is needed. A full
+// queue drops the new event and counts it. T defaults to BleEvent; small
+// copyable records (received frames, requests) use the same ring.
+template<size_t N, typename T = BleEvent>
+class BleEventQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // Producer side (host task)
+    bool post(const T& event) {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= N) {
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        events_[head & (N - 1)] = event;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side (loop task)
+    bool pop(T& event) {
+        const uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+        event = events_[tail & (N - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return N; }
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    T events_[N] = {};
+    std::atomic<uint32_t> head_ {0};
+    std::atomic<uint32_t> tail_ {0};
+    std::atomic<uint32_t> dropped_ {0};
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <NimBLEDevice.h>
+
+#include "LinkQuality.h"
+
+// =======================================================
+// Glue between TxPowerController levels and the ESP32 controller
+//
+// NimBLE-Arduino 2.x: setPower() takes dBm (not an esp_power_level_t)
+// and rounds to the nearest level the controller supports.
+// =======================================================
+inline void bleApplyTxPowerLevel(uint8_t level) {
+    if (level > TX_POWER_LEVEL_MAX) {
+        level = TX_POWER_LEVEL_MAX;
+    }
+    NimBLEDevice::setPower(TX_POWER_LEVELS[level].dbm);
+}
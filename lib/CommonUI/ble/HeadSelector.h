@@ -0,0 +1,197 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ble/AdvStatus.h"
+#include "ble/LinkQuality.h"
+
+// =======================================================
+// Nearest head selection (BBLC scan)
+//
+// Instead of connecting to the first BBLH heard, candidates are
+// collected for a bounded window and scored:
+//   score = filtered RSSI (RssiEwma, Q4) + readyBonusDb if READY
+// Heads advertising FAULT, an existing controller or no free slot are
+// not eligible (the head would refuse us anyway).
+//
+// The window ends early when the decision is already clear:
+// - the leader is "in hand" (>= nearDbm), or
+// - after minWindowMs, the leader beats the runner-up by marginDb.
+// Either way the leader needs minSamples advertisements, so a single
+// lucky packet never wins. At windowMs the best eligible head is
+// picked; with none, the caller restarts the window.
+//
+// At most MAX heads are tracked. When the table is full, a new head
+// takes the slot of an ineligible one, else of the weakest if it is
+// heard stronger; a weaker newcomer is ignored. Once picked, the table
+// no longer changes.
+//
+// Pure logic. Addr only needs operator==, time comes in as arguments.
+// =======================================================
+struct HeadSelectConfig {
+    uint32_t minWindowMs = 300;    // give every head a chance to be heard
+    uint32_t windowMs = 1500;      // hard bound on the selection time
+    uint8_t minSamples = 3;
+    uint8_t marginDb = 8;          // "clearly strongest"
+    int8_t nearDbm = -45;          // at arm's length, no need to wait
+    int8_t floorDbm = -90;         // ignored below this
+    uint8_t readyBonusDb = 3;
+};
+
+enum class HeadSelectResult : uint8_t {
+    COLLECTING,   // keep scanning
+    PICKED,       // picked() holds the head to connect to
+    EMPTY,        // window over, nothing eligible: restart
+};
+
+inline const char* headSelectResultToString(HeadSelectResult r) {
+    switch (r) {
+        case HeadSelectResult::COLLECTING: return "COLLECTING";
+        case HeadSelectResult::PICKED:     return "PICKED";
+        case HeadSelectResult::EMPTY:      return "EMPTY";
+        default:                           return "UNKNOWN";
+    }
+}
+
+template<typename Addr, size_t MAX = 16>
+class HeadSelector {
+public:
+    struct Candidate {
+        Addr address;
+        RssiEwma rssi;
+        uint16_t samples;
+        bool eligible;
+        bool ready;
+
+        int8_t rssiDbm() const { return rssi.dbm(); }
+    };
+
+    void configure(const HeadSelectConfig& config) { config_ = config; }
+    const HeadSelectConfig& config() const { return config_; }
+
+    void begin(uint32_t nowMs) {
+        count_ = 0;
+        startMs_ = nowMs;
+        picked_ = -1;
+        early_ = false;
+    }
+
+    // One advertisement. status: nullptr when the head does not broadcast one.
+    void observe(const Addr& address, int8_t rssiDbm, const AdvStatus* status) {
+        if (rssiDbm < config_.floorDbm) return;
+
+        Candidate* c = find(address);
+        if (!c) {
+            c = slotFor(rssiDbm);
+            if (!c) return;   // crowded hall, weaker than every tracked head
+            c->address = address;
+            c->rssi.reset();
+            c->samples = 0;
+        }
+        c->rssi.add(rssiDbm);
+        if (c->samples < UINT16_MAX) ++c->samples;
+
+        // Latest advertised state wins
+        c->eligible = !status || isEligible(status->flags);
+        c->ready = status && (status->flags & AdvStatusFlag::READY);
+    }
+
+    HeadSelectResult poll(uint32_t nowMs) {
+        if (picked_ >= 0) return HeadSelectResult::PICKED;
+
+        const uint32_t elapsed = nowMs - startMs_;
+        int best = -1;
+        int second = -1;
+        rank(best, second);
+
+        if (best >= 0 && candidates_[best].samples >= config_.minSamples) {
+            const int16_t lead = score(candidates_[best]);
+            const bool near = candidates_[best].rssi.q4() >= config_.nearDbm * 16;
+            const bool clear = elapsed >= config_.minWindowMs &&
+                (second < 0 || lead - score(candidates_[second]) >= config_.marginDb * 16);
+            if (near || clear) {
+                return pick(best, nowMs, true);
+            }
+        }
+
+        if (elapsed < config_.windowMs) return HeadSelectResult::COLLECTING;
+        if (best < 0) return HeadSelectResult::EMPTY;
+        return pick(best, nowMs, false);
+    }
+
+    // Time left before poll() has to give an answer
+    uint32_t msUntilDecision(uint32_t nowMs) const {
+        if (picked_ >= 0) return 0;
+        const uint32_t elapsed = nowMs - startMs_;
+        return elapsed >= config_.windowMs ? 0 : config_.windowMs - elapsed;
+    }
+
+    // The head chosen by the last PICKED poll(), nullptr before that.
+    // The selection details below are only meaningful once picked.
+    const Candidate* picked() const { return picked_ >= 0 ? &candidates_[picked_] : nullptr; }
+    uint32_t selectionMs() const { return pickedMs_ - startMs_; }
+    bool pickedEarly() const { return early_; }
+    size_t candidates() const { return count_; }
+
+private:
+    static bool isEligible(uint8_t flags) {
+        if (flags & (AdvStatusFlag::FAULT | AdvStatusFlag::HAS_CONTROLLER)) return false;
+        return flags & AdvStatusFlag::SLOT_FREE;
+    }
+
+    int16_t score(const Candidate& c) const {
+        return static_cast<int16_t>(c.rssi.q4() + (c.ready ? config_.readyBonusDb * 16 : 0));
+    }
+
+    // Free slot, else the one to evict for a newcomer heard at rssiDbm
+    Candidate* slotFor(int8_t rssiDbm) {
+        if (count_ < MAX) return &candidates_[count_++];
+        if (picked_ >= 0) return nullptr;
+
+        Candidate* weakest = nullptr;
+        for (size_t i = 0; i < count_; ++i) {
+            Candidate& c = candidates_[i];
+            if (!c.eligible) return &c;
+            if (!weakest || score(c) < score(*weakest)) weakest = &c;
+        }
+        return rssiDbm * 16 > score(*weakest) ? weakest : nullptr;
+    }
+
+    Candidate* find(const Addr& address) {
+        for (size_t i = 0; i < count_; ++i) {
+            if (candidates_[i].address == address) return &candidates_[i];
+        }
+        return nullptr;
+    }
+
+    void rank(int& best, int& second) const {
+        for (size_t i = 0; i < count_; ++i) {
+            const Candidate& c = candidates_[i];
+            if (!c.eligible) continue;
+
+            const int idx = static_cast<int>(i);
+            if (best < 0 || score(c) > score(candidates_[best])) {
+                second = best;
+                best = idx;
+            } else if (second < 0 || score(c) > score(candidates_[second])) {
+                second = idx;
+            }
+        }
+    }
+
+    HeadSelectResult pick(int idx, uint32_t nowMs, bool early) {
+        picked_ = idx;
+        pickedMs_ = nowMs;
+        early_ = early;
+        return HeadSelectResult::PICKED;
+    }
+
+    HeadSelectConfig config_;
+    Candidate candidates_[MAX];
+    size_t count_ = 0;
+    uint32_t startMs_ = 0;
+    uint32_t pickedMs_ = 0;
+    int picked_ = -1;
+    bool early_ = false;
+};
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =======================================================
+// Link quality monitor + adaptive TX power policy
+//
+// Pure logic (no Arduino / NimBLE dependency) so it can be
+// fed synthetic RSSI traces on a host. The BLE glue lives in
+// BleTxPower.h.
+// =======================================================
+
+struct TxPowerLevel {
+    int8_t dbm;
+    uint8_t currentMa;   // estimated radio current while transmitting
+};
+
+// Levels available on the ESP32-C3 controller, lowest first.
+// Current values are rough datasheet estimates, calibrate on the bench.
+static constexpr TxPowerLevel TX_POWER_LEVELS[] = {
+    {-12, 63},
+    { -9, 68},
+    { -6, 74},
+    { -3, 81},
+    {  0, 89},
+    {  3, 98},
+    {  6, 110},
+    {  9, 125},
+};
+
+static constexpr uint8_t TX_POWER_LEVEL_COUNT =
+    sizeof(TX_POWER_LEVELS) / sizeof(TX_POWER_LEVELS[0]);
+static constexpr uint8_t TX_POWER_LEVEL_MAX = TX_POWER_LEVEL_COUNT - 1;
+
+struct LinkQualitySnapshot {
+    bool hasRssi;
+    int8_t rssiDbm;            // filtered RSSI of the peer
+    uint16_t txCount;          // operations in the current window
+    uint16_t errorPermille;    // failed operations / txCount
+    uint16_t retries;
+};
+
+// =========================
+// RssiEwma
+// =========================
+// EWMA with alpha = 1/4, kept in Q4 to avoid floats. Steps are rounded
+// to nearest: truncating toward zero leaves a negative RSSI stuck up to
+// one dBm above the real value, which biases the path loss estimate.
+// The first sample seeds the filter.
+class RssiEwma {
+public:
+    void reset() {
+        has_ = false;
+        q4_ = 0;
+    }
+
+    void add(int8_t rssiDbm) {
+        const int16_t sampleQ4 = static_cast<int16_t>(rssiDbm) * 16;
+        if (!has_) {
+            q4_ = sampleQ4;
+            has_ = true;
+            return;
+        }
+        q4_ += divRound(sampleQ4 - q4_, 4);
+    }
+
+    bool has() const { return has_; }
+    int16_t q4() const { return q4_; }
+    int8_t dbm() const { return static_cast<int8_t>(divRound(q4_, 16)); }
+
+private:
+    // Division rounded half away from zero (integer division truncates).
+    static int16_t divRound(int16_t value, int16_t divisor) {
+        return static_cast<int16_t>(
+            (value >= 0 ? value + divisor / 2 : value - divisor / 2) / divisor);
+    }
+
+    bool has_ = false;
+    int16_t q4_ = 0;
+};
+
+// =========================
+// LinkQualityMonitor
+// =========================
+class LinkQualityMonitor {
+public:
+    void reset() {
+        rssi_.reset();
+        startWindow();
+    }
+
+    // Clears the packet counters, keeps the RSSI filter.
+    void startWindow() {
+        txCount_ = 0;
+        errorCount_ = 0;
+        retries_ = 0;
+    }
+
+    void addRssi(int8_t rssiDbm) { rssi_.add(rssiDbm); }
+
+    void addTxResult(bool ok) {
+        if (txCount_ < UINT16_MAX) ++txCount_;
+        if (!ok && errorCount_ < UINT16_MAX) ++errorCount_;
+    }
+
+    void addRetry() {
+        if (retries_ < UINT16_MAX) ++retries_;
+    }
+
+    LinkQualitySnapshot snapshot() const {
+        LinkQualitySnapshot s;
+        s.hasRssi = rssi_.has();
+        s.rssiDbm = rssi_.dbm();
+        s.txCount = txCount_;
+        s.errorPermille = txCount_
+            ? static_cast<uint16_t>((static_cast<uint32_t>(errorCount_) * 1000u) / txCount_)
+            : 0;
+        s.retries = retries_;
+        return s;
+    }
+
+private:
+    RssiEwma rssi_;
+    uint16_t txCount_ = 0;
+    uint16_t errorCount_ = 0;
+    uint16_t retries_ = 0;
+};
+
+// =========================
+// TxPowerController
+// =========================
+struct TxPowerPolicy {
+    int8_t sensitivityDbm = -94;     // receiver sensitivity (1M PHY)
+    uint8_t targetMarginDb = 15;     // margin kept above sensitivity at the peer
+    uint8_t hysteresisDb = 6;        // extra margin required before stepping down
+    uint8_t downHoldSamples = 4;     // consecutive good samples before a step down
+    uint16_t minTxForErrorRate = 8;  // ignore error rate below this many ops
+    uint16_t maxErrorPermille = 50;  // above this, jump straight to max power
+    uint16_t maxRetries = 4;
+};
+
+/**
+ * @brief Chooses the lowest TX power level that keeps the target margin.
+ *
+ * The peer RSSI alone is not enough: it depends on the peer's own TX power,
+ * which also adapts. Both sides therefore publish their TX power (LINK_TX
+ * frame) and the controller works on the path loss (peerTx - rssi), which is
+ * the same in both directions.
+ *
+ * Steps down one level at a time after `downHoldSamples` good samples,
+ * steps up in a single jump as soon as the margin or error rate degrades.
+ */
+class TxPowerController {
+public:
+    explicit TxPowerController(const TxPowerPolicy& policy = TxPowerPolicy())
+        : policy_(policy) {}
+
+    void reset() {
+        level_ = TX_POWER_LEVEL_MAX;
+        goodSamples_ = 0;
+    }
+
+    uint8_t level() const { return level_; }
+    int8_t dbm() const { return TX_POWER_LEVELS[level_].dbm; }
+    uint8_t currentMa() const { return TX_POWER_LEVELS[level_].currentMa; }
+
+    // Returns true when the level changed.
+    bool update(const LinkQualitySnapshot& q, int8_t peerTxDbm) {
+        const uint8_t previous = level_;
+
+        const bool errorsHigh =
+            (q.txCount >= policy_.minTxForErrorRate && q.errorPermille > policy_.maxErrorPermille) ||
+            q.retries > policy_.maxRetries;
+
+        if (errorsHigh) {
+            level_ = TX_POWER_LEVEL_MAX;
+            goodSamples_ = 0;
+            return level_ != previous;
+        }
+
+        if (!q.hasRssi) {
+            return false;
+        }
+
+        const int16_t pathLoss = static_cast<int16_t>(peerTxDbm) - q.rssiDbm;
+
+        if (marginAt(level_, pathLoss) < policy_.targetMarginDb) {
+            level_ = lowestLevelFor(pathLoss, policy_.targetMarginDb);
+            goodSamples_ = 0;
+            return level_ != previous;
+        }
+
+        if (level_ > 0 &&
+            marginAt(level_ - 1, pathLoss) >= policy_.targetMarginDb + policy_.hysteresisDb) {
+            if (++goodSamples_ >= policy_.downHoldSamples) {
+                --level_;
+                goodSamples_ = 0;
+            }
+        } else {
+            goodSamples_ = 0;
+        }
+
+        return level_ != previous;
+    }
+
+private:
+    // Predicted margin above sensitivity at the peer if we transmit at `level`.
+    int16_t marginAt(uint8_t level, int16_t pathLoss) const {
+        return static_cast<int16_t>(TX_POWER_LEVELS[level].dbm) - pathLoss - policy_.sensitivityDbm;
+    }
+
+    uint8_t lowestLevelFor(int16_t pathLoss, int16_t margin) const {
+        for (uint8_t i = 0; i < TX_POWER_LEVEL_COUNT; ++i) {
+            if (marginAt(i, pathLoss) >= margin) {
+                return i;
+            }
+        }
+        return TX_POWER_LEVEL_MAX;
+    }
+
+    TxPowerPolicy policy_;
+    uint8_t level_ = TX_POWER_LEVEL_MAX;
+    uint8_t goodSamples_ = 0;
+};
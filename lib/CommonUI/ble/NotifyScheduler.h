@@ -0,0 +1,276 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// =======================================================
+// Outbound notification scheduler (BBLH -> centrals)
+//
+// Priority lanes, strict order:
+//   CONTROL > FAULT > STATUS > TELEMETRY > BULK
+//
+// - CONTROL / FAULT: FIFO, a full lane refuses new messages.
+// - STATUS / TELEMETRY: latest value per (key, target). A newer
+//   update overwrites the queued one in place, stale values are
+//   never sent. A full lane evicts its oldest entry.
+// - BULK: pull lane. Large producers (launch log export) check
+//   bulkAllowed() and only send when every other lane is empty.
+//
+// The scheduler only decides the order. Flow control is the
+// caller's: the stack's free TX buffers are checked before each
+// notify, and a pump stops at the first refusal, leaving the message
+// queued for the next one. A BROADCAST cut short that way remembers
+// the targets it reached (markReached) and only the others get it on
+// the next pump; an update in place sends the new value to everybody.
+//
+// Pure logic, time and the actual send are passed in by the caller.
+// =======================================================
+enum class NotifyLane : uint8_t {
+    CONTROL,     // acks, command replies
+    FAULT,       // fault / error reports
+    STATUS,      // head status (latest value)
+    TELEMETRY,   // periodic measurements (latest value)
+    BULK,        // log export, pull only
+    COUNT
+};
+
+static constexpr size_t NOTIFY_LANE_COUNT = static_cast<size_t>(NotifyLane::COUNT);
+// Lanes with a queue: every one above BULK
+static constexpr size_t NOTIFY_QUEUED_LANE_COUNT = static_cast<size_t>(NotifyLane::BULK);
+
+inline const char* notifyLaneToString(NotifyLane lane) {
+    switch (lane) {
+        case NotifyLane::CONTROL:   return "CONTROL";
+        case NotifyLane::FAULT:     return "FAULT";
+        case NotifyLane::STATUS:    return "STATUS";
+        case NotifyLane::TELEMETRY: return "TELEMETRY";
+        case NotifyLane::BULK:      return "BULK";
+        default:                    return "UNKNOWN";
+    }
+}
+
+inline bool notifyLaneCoalesces(NotifyLane lane) {
+    return lane == NotifyLane::STATUS || lane == NotifyLane::TELEMETRY;
+}
+
+struct NotifyLaneStats {
+    uint32_t enqueued = 0;
+    uint32_t sent = 0;
+    uint32_t coalesced = 0;   // overwritten before being sent
+    uint32_t dropped = 0;     // refused (FIFO full) or evicted (oldest)
+    uint32_t totalUs = 0;     // enqueue -> send latency
+    uint32_t maxUs = 0;
+
+    uint32_t avgUs() const { return sent ? totalUs / sent : 0; }
+};
+
+// FANOUT: most subscribers a BROADCAST is delivered to
+template<size_t DEPTH = 8, size_t MAX_FRAME = 64, size_t FANOUT = 4>
+class NotifyScheduler {
+public:
+    static constexpr uint16_t BROADCAST = 0xFFFF;
+
+    struct Message {
+        NotifyLane lane;
+        uint8_t key;         // coalescing key (usually the opcode), lanes that coalesce only
+        uint16_t target;     // conn handle or BROADCAST
+        uint16_t len;
+        uint32_t enqueuedUs;
+        uint32_t id;         // unique per queued message
+        uint32_t version;    // bumped on coalesce, see complete()
+        uint8_t reachedCount;        // BROADCAST: targets already served this version
+        uint16_t reached[FANOUT];
+        uint8_t data[MAX_FRAME];
+
+        bool hasReached(uint16_t conn) const {
+            for (size_t i = 0; i < reachedCount; ++i) {
+                if (reached[i] == conn) return true;
+            }
+            return false;
+        }
+    };
+
+    NotifyScheduler() { reset(); }
+
+    void reset() {
+        for (size_t l = 0; l < NOTIFY_QUEUED_LANE_COUNT; ++l) {
+            lanes_[l].head = 0;
+            lanes_[l].count = 0;
+        }
+        for (size_t l = 0; l < NOTIFY_LANE_COUNT; ++l) {
+            stats_[l] = NotifyLaneStats();
+        }
+    }
+
+    // Returns false when the message was refused (too large / FIFO lane full).
+    bool enqueue(NotifyLane lane, uint16_t target, const uint8_t* data, size_t len,
+                 uint32_t nowUs, uint8_t key = 0) {
+        const size_t l = static_cast<size_t>(lane);
+        if (l >= NOTIFY_QUEUED_LANE_COUNT || len > MAX_FRAME) return false;   // BULK is pull only
+
+        Lane& q = lanes_[l];
+        NotifyLaneStats& st = stats_[l];
+        ++st.enqueued;
+
+        if (notifyLaneCoalesces(lane)) {
+            for (size_t i = 0; i < q.count; ++i) {
+                Message& m = q.at(i);
+                if (m.key == key && m.target == target) {
+                    fill(m, data, len);   // keeps its place and its enqueue time
+                    ++m.version;
+                    m.reachedCount = 0;   // new value, every target again
+                    ++st.coalesced;
+                    return true;
+                }
+            }
+            if (q.count == DEPTH) {
+                q.pop();                  // oldest value is the stalest
+                ++st.dropped;
+            }
+        } else if (q.count == DEPTH) {
+            ++st.dropped;
+            return false;
+        }
+
+        Message& m = q.push();
+        m.lane = lane;
+        m.key = key;
+        m.target = target;
+        m.enqueuedUs = nowUs;
+        m.id = nextId_++;
+        m.version = 0;
+        m.reachedCount = 0;
+        fill(m, data, len);
+        return true;
+    }
+
+    // Copies the highest priority message out, without popping it. Send
+    // it, then call complete().
+    bool next(Message& out) const {
+        for (size_t l = 0; l < NOTIFY_QUEUED_LANE_COUNT; ++l) {
+            if (lanes_[l].count) {
+                out = lanes_[l].at(0);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // issued: notifications of this value handed to the stack, earlier
+    // partial broadcast passes included (0 = backpressure, keep the
+    // message for the next pump). A message updated in place since
+    // next() stays queued so its newer value still goes out; one evicted
+    // meanwhile is simply gone.
+    void complete(const Message& sent, size_t issued, uint32_t nowUs) {
+        if (issued == 0) return;
+
+        const size_t l = static_cast<size_t>(sent.lane);
+        Lane& q = lanes_[l];
+        NotifyLaneStats& st = stats_[l];
+
+        const uint32_t latency = nowUs - sent.enqueuedUs;
+        ++st.sent;
+        st.totalUs += latency;
+        if (latency > st.maxUs) st.maxUs = latency;
+
+        if (!q.count || q.at(0).id != sent.id) return;
+        Message& head = q.at(0);
+        if (head.version == sent.version) {
+            q.pop();
+        } else {
+            head.enqueuedUs = nowUs;   // newer value, latency counts from now
+        }
+    }
+
+    // BROADCAST fan-out stopped by backpressure: records the targets this
+    // pass reached, the message stays queued for the others. Ignored when
+    // the value was updated in place since next().
+    void markReached(const Message& sent, const uint16_t* targets, size_t count) {
+        Lane& q = lanes_[static_cast<size_t>(sent.lane)];
+        if (!q.count || q.at(0).id != sent.id || q.at(0).version != sent.version) return;
+
+        Message& head = q.at(0);
+        for (size_t i = 0; i < count && head.reachedCount < FANOUT; ++i) {
+            if (!head.hasReached(targets[i])) head.reached[head.reachedCount++] = targets[i];
+        }
+    }
+
+    // BULK producers: send only when nothing else waits, then count it.
+    bool bulkAllowed() const { return !pendingAbove(NotifyLane::BULK); }
+    void bulkSent() { ++stats_[static_cast<size_t>(NotifyLane::BULK)].sent; }
+
+    // Drops the head message (no subscriber left for it).
+    void discard(const Message& m) {
+        Lane& q = lanes_[static_cast<size_t>(m.lane)];
+        if (q.count && q.at(0).id == m.id) {
+            q.pop();
+            ++stats_[static_cast<size_t>(m.lane)].dropped;
+        }
+    }
+
+    // Drops everything addressed to a closed connection, and forgets it in
+    // partial broadcasts (a new link may reuse the handle).
+    void dropTarget(uint16_t target) {
+        for (size_t l = 0; l < NOTIFY_QUEUED_LANE_COUNT; ++l) {
+            Lane& q = lanes_[l];
+            size_t kept = 0;
+            for (size_t i = 0; i < q.count; ++i) {
+                Message& m = q.at(i);
+                if (m.target != target) {
+                    forgetReached(m, target);
+                    if (kept != i) q.at(kept) = m;
+                    ++kept;
+                }
+            }
+            stats_[l].dropped += q.count - kept;
+            q.count = kept;
+        }
+    }
+
+    bool pendingAbove(NotifyLane lane) const {
+        for (size_t l = 0; l < static_cast<size_t>(lane) && l < NOTIFY_QUEUED_LANE_COUNT; ++l) {
+            if (lanes_[l].count) return true;
+        }
+        return false;
+    }
+
+    size_t pending(NotifyLane lane) const {
+        const size_t l = static_cast<size_t>(lane);
+        return l < NOTIFY_QUEUED_LANE_COUNT ? lanes_[l].count : 0;
+    }
+    const NotifyLaneStats& stats(NotifyLane lane) const { return stats_[static_cast<size_t>(lane)]; }
+
+private:
+    struct Lane {
+        Message slots[DEPTH] = {};
+        size_t head = 0;
+        size_t count = 0;
+
+        Message& at(size_t i) { return slots[(head + i) % DEPTH]; }
+        const Message& at(size_t i) const { return slots[(head + i) % DEPTH]; }
+        Message& push() { return slots[(head + count++) % DEPTH]; }
+        void pop() {
+            head = (head + 1) % DEPTH;
+            --count;
+        }
+    };
+
+    static void forgetReached(Message& m, uint16_t target) {
+        for (size_t i = 0; i < m.reachedCount; ++i) {
+            if (m.reached[i] == target) {
+                m.reached[i] = m.reached[--m.reachedCount];
+                return;
+            }
+        }
+    }
+
+    static void fill(Message& m, const uint8_t* data, size_t len) {
+        memcpy(m.data, data, len);
+        m.len = static_cast<uint16_t>(len);
+    }
+
+    Lane lanes_[NOTIFY_QUEUED_LANE_COUNT];   // no storage for BULK
+    NotifyLaneStats stats_[NOTIFY_LANE_COUNT];
+    uint32_t nextId_ = 0;
+};
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =======================================================
+// Per-connection state for a multi-client BBLH
+//
+// Pure logic (no NimBLE dependency). `Ext` carries whatever the
+// server wants to keep per link (address, link quality...).
+// Not thread safe: the owner locks around every call and copies
+// handles out (subscribers(), handles()) before calling the stack.
+// =======================================================
+
+// Declared by the central with a HELLO frame after connecting.
+enum class PeerRole : uint8_t {
+    NONE       = 0,   // not declared yet, read-only
+    CONTROLLER = 1,   // player controller (BBLC), the only one allowed to fire
+    REFEREE    = 2,   // referee / scoreboard, status only
+};
+
+inline const char* peerRoleToString(PeerRole role) {
+    switch (role) {
+        case PeerRole::NONE:       return "NONE";
+        case PeerRole::CONTROLLER: return "CONTROLLER";
+        case PeerRole::REFEREE:    return "REFEREE";
+        default:                   return "UNKNOWN";
+    }
+}
+
+struct PeerNotifyStats {
+    uint32_t ok = 0;
+    uint32_t failed = 0;
+    uint32_t totalUs = 0;   // time spent in notify calls for this peer
+    uint32_t maxUs = 0;
+
+    uint32_t avgUs() const { return ok + failed ? totalUs / (ok + failed) : 0; }
+};
+
+template<typename Ext>
+struct PeerSlot {
+    bool used = false;
+    uint16_t connHandle = 0;
+    PeerRole role = PeerRole::NONE;
+    bool subscribed = false;
+    uint32_t connectedAtMs = 0;
+    PeerNotifyStats notify;
+    Ext ext {};
+};
+
+template<size_t N, typename Ext>
+class PeerTable {
+public:
+    using Slot = PeerSlot<Ext>;
+
+    static constexpr size_t capacity() { return N; }
+    size_t count() const { return count_; }
+    bool full() const { return count_ == N; }
+    bool empty() const { return count_ == 0; }
+
+    // Returns nullptr when every slot is taken.
+    Slot* add(uint16_t connHandle, uint32_t nowMs) {
+        if (find(connHandle)) {
+            return nullptr;
+        }
+        for (auto& s : slots_) {
+            if (!s.used) {
+                s = Slot();
+                s.used = true;
+                s.connHandle = connHandle;
+                s.connectedAtMs = nowMs;
+                ++count_;
+                return &s;
+            }
+        }
+        return nullptr;
+    }
+
+    bool remove(uint16_t connHandle) {
+        Slot* s = find(connHandle);
+        if (!s) return false;
+        s->used = false;
+        --count_;
+        return true;
+    }
+
+    Slot* find(uint16_t connHandle) {
+        for (auto& s : slots_) {
+            if (s.used && s.connHandle == connHandle) return &s;
+        }
+        return nullptr;
+    }
+
+    const Slot* find(uint16_t connHandle) const {
+        return const_cast<PeerTable*>(this)->find(connHandle);
+    }
+
+    // Only one CONTROLLER at a time; the claim is refused while
+    // another connection holds it.
+    bool claimRole(uint16_t connHandle, PeerRole role) {
+        Slot* s = find(connHandle);
+        if (!s) return false;
+
+        if (role == PeerRole::CONTROLLER) {
+            for (const auto& other : slots_) {
+                if (other.used && &other != s && other.role == PeerRole::CONTROLLER) {
+                    return false;
+                }
+            }
+        }
+
+        s->role = role;
+        return true;
+    }
+
+    bool hasRole(PeerRole role) const {
+        for (const auto& s : slots_) {
+            if (s.used && s.role == role) return true;
+        }
+        return false;
+    }
+
+    bool hasSubscriber() const {
+        for (const auto& s : slots_) {
+            if (s.used && s.subscribed) return true;
+        }
+        return false;
+    }
+
+    bool canFire(uint16_t connHandle) const {
+        const Slot* s = find(connHandle);
+        return s && s->role == PeerRole::CONTROLLER;
+    }
+
+    template<typename Fn>
+    void forEach(Fn fn) {
+        for (auto& s : slots_) {
+            if (s.used) fn(s);
+        }
+    }
+
+    // Copies the handles of the subscribed peers, so the caller can notify
+    // outside its lock. The starting slot rotates on each call so no client
+    // is always served first under load.
+    size_t subscribers(uint16_t (&out)[N]) {
+        size_t n = 0;
+        for (size_t i = 0; i < N; ++i) {
+            const Slot& s = slots_[(rotation_ + i) % N];
+            if (s.used && s.subscribed) out[n++] = s.connHandle;
+        }
+        rotation_ = (rotation_ + 1) % N;
+        return n;
+    }
+
+    // Copies the handles of every connected peer.
+    size_t handles(uint16_t (&out)[N]) const {
+        size_t n = 0;
+        for (const auto& s : slots_) {
+            if (s.used) out[n++] = s.connHandle;
+        }
+        return n;
+    }
+
+    static void recordNotify(Slot& s, bool ok, uint32_t us) {
+        if (ok) {
+            ++s.notify.ok;
+        } else {
+            ++s.notify.failed;
+        }
+        s.notify.totalUs += us;
+        if (us > s.notify.maxUs) s.notify.maxUs = us;
+    }
+
+private:
+    Slot slots_[N];
+    size_t count_ = 0;
+    size_t rotation_ = 0;
+};
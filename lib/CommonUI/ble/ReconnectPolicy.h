@@ -0,0 +1,218 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =======================================================
+// Reconnect policy (BBLC): backoff, jitter, circuit breaker
+//
+// After a failed attempt the controller waits before scanning again:
+//   cap   = min(maxMs, baseMs << attempts)   (REJECTED counts double)
+//   delay = cap / 2 + random(0, cap / 2)     ("equal jitter")
+// so retries spread out instead of colliding in lockstep, while a
+// controller never retries faster than cap / 2.
+//
+// A link lost after stableLinkMs is a fresh start: backoff is reset and
+// the first retry lands at random within a spread that grows with the
+// number of heads seen around (spreadPerHeadMs each, bounded), which is
+// what keeps a whole hall from reconnecting in lockstep after a glitch
+// while a lone pair still comes back at once. A link lost sooner is
+// flapping and counts as REJECTED.
+//
+// Circuit breaker per target address: each failure adds strikes
+// (TIMEOUT 1, REJECTED half the threshold, SERVICE_MISSING all of it:
+// two refusals or one foreign device are enough). At breakerStrikes the
+// target is blocked for breakerOpenMs (doubling on each trip, up to
+// breakerMaxOpenMs). When that expires one attempt is allowed, and a
+// new failure trips it again right away. A stable link clears it, and
+// so does breakerQuietMs without a failure (counted from the end of the
+// last open period): strikes from an old outage do not add up with
+// today's.
+//
+// Pure logic: Addr only needs operator==, time and the jitter seed
+// come from the caller.
+// =======================================================
+enum class ConnectFailure : uint8_t {
+    TIMEOUT,           // no answer / link establishment failed (range, collisions)
+    SERVICE_MISSING,   // connected, but not a usable BBLH
+    REJECTED,          // peer refused or dropped us (full, role denied, flapping)
+    COUNT
+};
+
+static constexpr size_t CONNECT_FAILURE_COUNT = static_cast<size_t>(ConnectFailure::COUNT);
+
+inline const char* connectFailureToString(ConnectFailure f) {
+    switch (f) {
+        case ConnectFailure::TIMEOUT:         return "TIMEOUT";
+        case ConnectFailure::SERVICE_MISSING: return "SERVICE_MISSING";
+        case ConnectFailure::REJECTED:        return "REJECTED";
+        default:                              return "UNKNOWN";
+    }
+}
+
+struct ReconnectConfig {
+    uint32_t baseMs = 250;             // first retry cap (the previous fixed delay)
+    uint32_t maxMs = 2000;             // longer only stretches the tail of a storm
+    uint32_t spreadPerHeadMs = 40;
+    uint32_t minSpreadMs = 250;
+    uint32_t maxSpreadMs = 4000;
+    uint32_t stableLinkMs = 5000;
+    uint8_t breakerStrikes = 12;       // ~12 timeouts in a row (10-20 s of backoff): gone or out of range
+    uint32_t breakerOpenMs = 15000;
+    uint32_t breakerMaxOpenMs = 120000;
+    uint32_t breakerQuietMs = 60000;
+};
+
+struct ReconnectStats {
+    uint32_t failures[CONNECT_FAILURE_COUNT] = {};
+    uint32_t linksLost = 0;
+    uint32_t breakerTrips = 0;
+};
+
+template<typename Addr, size_t MAX_TARGETS = 8>
+class ReconnectPolicy {
+public:
+    void configure(const ReconnectConfig& config) { config_ = config; }
+    const ReconnectConfig& config() const { return config_; }
+
+    // Any non-zero value, esp_random() on target
+    void seed(uint32_t seed) { rng_ = seed ? seed : 1; }
+
+    // Returns the delay before the next scan.
+    uint32_t onFailure(const Addr& target, ConnectFailure cause, uint32_t nowMs) {
+        const size_t c = static_cast<size_t>(cause);
+        if (c < CONNECT_FAILURE_COUNT) ++stats_.failures[c];
+
+        strike(target, cause, nowMs);
+
+        const uint8_t step = cause == ConnectFailure::REJECTED ? 2 : 1;
+        attempts_ = static_cast<uint8_t>(attempts_ + step > 31 ? 31 : attempts_ + step);
+        return backoff();
+    }
+
+    void onConnected(uint32_t nowMs) { linkUpMs_ = nowMs; }
+
+    // Heads heard during the last scan, sizes the reconnect spread
+    void setCrowd(uint16_t heads) { crowd_ = heads; }
+
+    // Link lost after onConnected(). Returns the delay before the next scan.
+    uint32_t onLinkLost(const Addr& target, uint32_t nowMs) {
+        ++stats_.linksLost;
+        if (nowMs - linkUpMs_ < config_.stableLinkMs) {
+            return onFailure(target, ConnectFailure::REJECTED, nowMs);
+        }
+
+        attempts_ = 0;
+        if (Target* t = find(target)) t->used = false;
+
+        uint32_t spread = config_.spreadPerHeadMs * crowd_;
+        if (spread < config_.minSpreadMs) spread = config_.minSpreadMs;
+        if (spread > config_.maxSpreadMs) spread = config_.maxSpreadMs;
+        return random(spread + 1);
+    }
+
+    // False while the target's breaker is open.
+    bool allows(const Addr& target, uint32_t nowMs) const {
+        const Target* t = find(target);
+        return !t || !t->open || static_cast<int32_t>(nowMs - t->openUntilMs) >= 0;
+    }
+
+    // Time before the target's breaker lets an attempt through, 0 if it does.
+    uint32_t msUntilAllowed(const Addr& target, uint32_t nowMs) const {
+        return allows(target, nowMs) ? 0 : find(target)->openUntilMs - nowMs;
+    }
+
+    uint8_t attempts() const { return attempts_; }
+    const ReconnectStats& stats() const { return stats_; }
+
+private:
+    struct Target {
+        bool used = false;
+        Addr address;
+        uint8_t strikes = 0;
+        bool open = false;
+        uint32_t openUntilMs = 0;
+        uint32_t openMs = 0;       // duration of the last trip
+        uint32_t lastFailureMs = 0;
+    };
+
+    uint8_t strikesFor(ConnectFailure cause) const {
+        switch (cause) {
+            case ConnectFailure::SERVICE_MISSING: return config_.breakerStrikes;
+            case ConnectFailure::REJECTED:        return static_cast<uint8_t>((config_.breakerStrikes + 1) / 2);
+            default:                              return 1;
+        }
+    }
+
+    uint32_t random(uint32_t range) {
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 17;
+        rng_ ^= rng_ << 5;
+        return range ? rng_ % range : 0;
+    }
+
+    uint32_t backoff() {
+        const uint32_t shift = attempts_ > 1 ? attempts_ - 1u : 0u;
+        uint32_t cap = shift >= 16 ? config_.maxMs : config_.baseMs << shift;
+        if (cap > config_.maxMs) cap = config_.maxMs;
+        return cap / 2 + random(cap / 2 + 1);
+    }
+
+    Target* find(const Addr& address) {
+        for (Target& t : targets_) {
+            if (t.used && t.address == address) return &t;
+        }
+        return nullptr;
+    }
+
+    const Target* find(const Addr& address) const {
+        for (const Target& t : targets_) {
+            if (t.used && t.address == address) return &t;
+        }
+        return nullptr;
+    }
+
+    void strike(const Addr& address, ConnectFailure cause, uint32_t nowMs) {
+        Target* t = find(address);
+        if (!t) {
+            // Free slot, else the target that failed longest ago
+            t = &targets_[0];
+            for (Target& s : targets_) {
+                if (!s.used) { t = &s; break; }
+                if (nowMs - s.lastFailureMs > nowMs - t->lastFailureMs) t = &s;
+            }
+            *t = Target();
+            t->used = true;
+            t->address = address;
+        }
+
+        // Quiet since the last failure, or since the breaker let us through
+        const uint32_t quietSince = t->open ? t->openUntilMs : t->lastFailureMs;
+        if (static_cast<int32_t>(nowMs - quietSince) >= static_cast<int32_t>(config_.breakerQuietMs)) {
+            t->strikes = 0;
+            t->open = false;
+            t->openMs = 0;
+        }
+
+        t->lastFailureMs = nowMs;
+        t->strikes = static_cast<uint8_t>(t->strikes + strikesFor(cause));
+        if (t->strikes < config_.breakerStrikes) return;
+
+        // Trip: doubled duration on every re-trip, one strike short of the
+        // threshold afterwards so the probe attempt gets a single chance
+        t->openMs = t->open ? t->openMs * 2 : config_.breakerOpenMs;
+        if (t->openMs > config_.breakerMaxOpenMs) t->openMs = config_.breakerMaxOpenMs;
+        t->open = true;
+        t->openUntilMs = nowMs + t->openMs;
+        t->strikes = static_cast<uint8_t>(config_.breakerStrikes - 1);
+        ++stats_.breakerTrips;
+    }
+
+    ReconnectConfig config_;
+    Target targets_[MAX_TARGETS];
+    uint8_t attempts_ = 0;
+    uint32_t linkUpMs_ = 0;
+    uint16_t crowd_ = 0;
+    uint32_t rng_ = 1;
+    ReconnectStats stats_;
+};
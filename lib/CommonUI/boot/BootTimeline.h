@@ -0,0 +1,131 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// =======================================================
+// Boot milestones, power-on to ready
+//
+// Each milestone keeps the micros() value of the first time it was
+// reached (micros() starts with the app, ROM + bootloader time is not
+// included). Slots are written independently, so the BLE init task
+// and setup() can mark in parallel.
+//
+// Wire format (BleProto::Op::BOOT_REPORT, BBLH -> BBLC):
+//   [op][count][count * (milestone u8, us u32 LE)]
+// =======================================================
+enum class BootMilestone : uint8_t {
+    SETUP_ENTRY,     // setup() reached
+    SERIAL_READY,    // Serial up (and host attached when waiting for it)
+    LED_READY,       // status LED driven
+    STORAGE_READY,   // BBLH launch log recovered
+    BLE_READY,       // NimBLE stack + GATT / scan objects up
+    SETUP_DONE,      // setup() returned
+    ADVERTISING,     // BBLH discoverable
+    SCANNING,        // BBLC scanning
+    CONNECTED,       // first link up
+    COUNT
+};
+
+static constexpr size_t BOOT_MILESTONE_COUNT = static_cast<size_t>(BootMilestone::COUNT);
+static constexpr size_t BOOT_REPORT_HEADER = 2;   // [op][count]
+static constexpr size_t BOOT_REPORT_ENTRY = 5;
+
+inline const char* bootMilestoneToString(BootMilestone m) {
+    switch (m) {
+        case BootMilestone::SETUP_ENTRY:   return "SETUP_ENTRY";
+        case BootMilestone::SERIAL_READY:  return "SERIAL_READY";
+        case BootMilestone::LED_READY:     return "LED_READY";
+        case BootMilestone::STORAGE_READY: return "STORAGE_READY";
+        case BootMilestone::BLE_READY:     return "BLE_READY";
+        case BootMilestone::SETUP_DONE:    return "SETUP_DONE";
+        case BootMilestone::ADVERTISING:   return "ADVERTISING";
+        case BootMilestone::SCANNING:      return "SCANNING";
+        case BootMilestone::CONNECTED:     return "CONNECTED";
+        default:                           return "UNKNOWN";
+    }
+}
+
+class BootTimeline {
+public:
+    static constexpr uint32_t NOT_REACHED = UINT32_MAX;
+
+    BootTimeline() { reset(); }
+
+    void reset() {
+        for (size_t i = 0; i < BOOT_MILESTONE_COUNT; ++i) atUs_[i] = NOT_REACHED;
+    }
+
+    // First call wins; returns false if already marked.
+    bool mark(BootMilestone m, uint32_t nowUs) {
+        const size_t i = static_cast<size_t>(m);
+        if (i >= BOOT_MILESTONE_COUNT || atUs_[i] != NOT_REACHED) return false;
+        atUs_[i] = nowUs;
+        return true;
+    }
+
+    bool reached(BootMilestone m) const { return atUs(m) != NOT_REACHED; }
+
+    uint32_t atUs(BootMilestone m) const {
+        const size_t i = static_cast<size_t>(m);
+        return i < BOOT_MILESTONE_COUNT ? atUs_[i] : NOT_REACHED;
+    }
+
+    // fn(milestone, us) in enum order, reached milestones only
+    template<typename Fn>
+    void forEachReached(Fn fn) const {
+        for (size_t i = 0; i < BOOT_MILESTONE_COUNT; ++i) {
+            if (atUs_[i] != NOT_REACHED) fn(static_cast<BootMilestone>(i), atUs_[i]);
+        }
+    }
+
+    // One benchmark line: "SETUP_ENTRY=312.4 LED_READY=313.1 ..." (ms)
+    size_t format(char* out, size_t len) const {
+        size_t pos = 0;
+        if (len) out[0] = '\0';
+        forEachReached([&](BootMilestone m, uint32_t us) {
+            if (pos >= len) return;
+            const int n = snprintf(out + pos, len - pos, "%s%s=%lu.%lu",
+                                   pos ? " " : "", bootMilestoneToString(m),
+                                   static_cast<unsigned long>(us / 1000),
+                                   static_cast<unsigned long>((us % 1000) / 100));
+            if (n > 0) pos += static_cast<size_t>(n);
+        });
+        return pos < len ? pos : len;
+    }
+
+    // Payload after the opcode; truncated to what fits in maxLen.
+    size_t encode(uint8_t* out, size_t maxLen) const {
+        if (maxLen < 1) return 0;
+        uint8_t count = 0;
+        size_t pos = 1;
+        forEachReached([&](BootMilestone m, uint32_t us) {
+            if (pos + BOOT_REPORT_ENTRY > maxLen) return;
+            out[pos] = static_cast<uint8_t>(m);
+            out[pos + 1] = static_cast<uint8_t>(us);
+            out[pos + 2] = static_cast<uint8_t>(us >> 8);
+            out[pos + 3] = static_cast<uint8_t>(us >> 16);
+            out[pos + 4] = static_cast<uint8_t>(us >> 24);
+            pos += BOOT_REPORT_ENTRY;
+            ++count;
+        });
+        out[0] = count;
+        return pos;
+    }
+
+    bool decode(const uint8_t* in, size_t len) {
+        if (len < 1 || len < 1 + static_cast<size_t>(in[0]) * BOOT_REPORT_ENTRY) return false;
+        reset();
+        for (size_t k = 0; k < in[0]; ++k) {
+            const uint8_t* e = in + 1 + k * BOOT_REPORT_ENTRY;
+            const uint32_t us = static_cast<uint32_t>(e[1]) | (static_cast<uint32_t>(e[2]) << 8) |
+                                (static_cast<uint32_t>(e[3]) << 16) | (static_cast<uint32_t>(e[4]) << 24);
+            mark(static_cast<BootMilestone>(e[0]), us);
+        }
+        return true;
+    }
+
+private:
+    volatile uint32_t atUs_[BOOT_MILESTONE_COUNT];
+};
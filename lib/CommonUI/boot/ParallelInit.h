@@ -0,0 +1,55 @@
+#pragma once
+
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+// =======================================================
+// Runs one init step (typically the BLE stack) in its own task
+// while setup() carries on with the peripherals, then joins.
+//
+// The step mostly waits on the controller / host sync, so even on
+// a single core the other init work fills that time.
+// Falls back to running inline if the task cannot be created.
+// =======================================================
+class ParallelInit {
+public:
+    using Step = std::function<void()>;
+
+    bool start(const char* name, Step step, uint32_t stackBytes = 6144) {
+        step_ = step;
+        done_ = xSemaphoreCreateBinaryStatic(&doneBuffer_);
+
+        // Same priority as the caller: neither side starves the other
+        if (xTaskCreate(&ParallelInit::run, name, stackBytes, this,
+                        uxTaskPriorityGet(nullptr), nullptr) != pdPASS) {
+            step_();
+            xSemaphoreGive(done_);
+            return false;
+        }
+        return true;
+    }
+
+    // Returns false on timeout
+    bool wait(uint32_t timeoutMs = UINT32_MAX) {
+        const TickType_t ticks = timeoutMs == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+        if (!done_ || xSemaphoreTake(done_, ticks) != pdTRUE) {
+            return false;
+        }
+        xSemaphoreGive(done_);   // later waits return immediately
+        return true;
+    }
+
+private:
+    static void run(void* arg) {
+        ParallelInit* self = static_cast<ParallelInit*>(arg);
+        self->step_();
+        xSemaphoreGive(self->done_);
+        vTaskDelete(nullptr);
+    }
+
+    Step step_;
+    StaticSemaphore_t doneBuffer_;
+    SemaphoreHandle_t done_ = nullptr;
+};
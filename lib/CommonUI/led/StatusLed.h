@@ -39,6 +39,7 @@ public:
         current = style;
         lastUpdate = millis();
         ledOn = false;
+        shown = false;   // next update() draws the new style
     }
 
     void update() {
@@ -71,6 +72,10 @@ public:
                 break;
 
             case LedPattern::PULSE: {
+                if (now - lastUpdate < PULSE_FRAME_MS) {
+                    break;
+                }
+                lastUpdate = now;
                 uint8_t brightness = beatsin8(20, 30, 255);
                 CRGB c = current.color1;
                 c.nscale8(brightness);
@@ -80,16 +85,39 @@ public:
         }
     }
 
+    // Time until update() has something new to draw, so the caller can
+    // sleep in between. UINT32_MAX for static patterns (OFF / SOLID).
+    uint32_t msUntilNextFrame(uint32_t now) const {
+        uint32_t period;
+        switch (current.pattern) {
+            case LedPattern::BLINK:     period = ledOn ? current.onMs : current.offMs; break;
+            case LedPattern::ALTERNATE: period = current.onMs; break;
+            case LedPattern::PULSE:     period = PULSE_FRAME_MS; break;
+            default:
+                return shown ? UINT32_MAX : 0;
+        }
+
+        const uint32_t elapsed = now - lastUpdate;
+        return elapsed >= period ? 0 : period - elapsed;
+    }
+
 private:
     static constexpr uint8_t NUM_LEDS = 1;
+    static constexpr uint32_t PULSE_FRAME_MS = 20;   // 50 fps is smooth enough for one LED
     CRGB leds[NUM_LEDS];
 
     LedStyle current {LedPattern::OFF, CRGB::Black, CRGB::Black, 0, 0};
     uint32_t lastUpdate {0};
     bool ledOn {false};
+    bool shown {false};
 
+    // Only push to the strip when the color actually changes
     void setColor(const CRGB& color) {
+        if (shown && leds[0] == color) {
+            return;
+        }
         leds[0] = color;
         FastLED.show();
+        shown = true;
     }
 };
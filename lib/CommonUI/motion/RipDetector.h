@@ -0,0 +1,182 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =======================================================
+// "Rip" gesture detection (BBLC, fire by pulling the controller)
+//
+// Fixed-point chain, one pass per sample, run on FIFO batches:
+//   1. high-pass per axis (DC tracker) removes gravity and gyro bias
+//   2. feature = |accel| + |gyro| >> gyroShift (L1 norms, raw LSB)
+//   3. short envelope (one-pole low-pass) rejects single-sample spikes
+//   4. trigger: envelope above onThreshold for confirmSamples in a row,
+//      aborted as soon as it falls below offThreshold (taps, knocks)
+//   5. lockout: refractoryUs, then the envelope must settle below
+//      offThreshold before the next gesture can start
+//
+// The event is emitted at confirmation, not at the end of the motion:
+// strength is the envelope peak seen so far, mapped to 0..255.
+//
+// Units are raw sensor LSB (defaults: accel +-16 g ~ 2048 LSB/g,
+// gyro +-2000 dps ~ 14.3 LSB/dps). Pure logic: samples and their
+// timestamps come from the caller, see RipPipeline.h for the driver side.
+// =======================================================
+struct ImuSample {
+    int16_t ax, ay, az;
+    int16_t gx, gy, gz;
+};
+
+struct RipConfig {
+    uint8_t dcShift = 8;            // high-pass time constant, 2^n samples (~150 ms at 1.66 kHz)
+    uint8_t envShift = 2;           // envelope smoothing, 2^n samples
+    uint8_t gyroShift = 2;          // gyro weight in the feature
+    int32_t onThreshold = 6144;     // ~3 g
+    int32_t offThreshold = 3072;    // ~1.5 g, hysteresis
+    int32_t fullScale = 12288;      // ~6 g at confirmation -> strength 255
+    uint16_t confirmSamples = 6;    // ~3.6 ms at 1.66 kHz
+    uint32_t refractoryUs = 400000;
+};
+
+struct RipEvent {
+    uint32_t onsetUs;      // first sample above onThreshold
+    uint32_t detectedUs;   // confirmation sample
+    uint8_t strength;      // 0..255
+    int32_t peak;          // envelope peak at confirmation, raw LSB
+};
+
+class RipDetector {
+public:
+    void configure(const RipConfig& config) {
+        config_ = config;
+        reset();
+    }
+
+    const RipConfig& config() const { return config_; }
+
+    void reset() {
+        for (int32_t& dc : dc_) dc = 0;
+        env_ = 0;
+        phase_ = Phase::SETTLING;
+        primed_ = false;
+        above_ = 0;
+        peak_ = 0;
+        onsetUs_ = 0;
+        lockoutUntilUs_ = 0;
+    }
+
+    // Consecutive samples, the last one taken at lastUs. Returns the number
+    // of events written to out (at most maxOut, extra events are lost).
+    size_t process(const ImuSample* samples, size_t count, uint32_t lastUs, uint32_t periodUs,
+                   RipEvent* out, size_t maxOut) {
+        size_t events = 0;
+        uint32_t t = lastUs - static_cast<uint32_t>(count ? count - 1 : 0) * periodUs;
+
+        for (size_t i = 0; i < count; ++i, t += periodUs) {
+            const int32_t env = filter(samples[i]);
+
+            RipEvent e;
+            if (step(env, t, e) && events < maxOut) {
+                out[events++] = e;
+            }
+        }
+        return events;
+    }
+
+    int32_t envelope() const { return env_; }
+
+private:
+    enum class Phase : uint8_t {
+        SETTLING,   // lockout / waiting for the envelope to come down
+        ARMED,
+        RISING,     // above onThreshold, not confirmed yet
+    };
+
+    static int32_t abs32(int32_t v) { return v < 0 ? -v : v; }
+
+    // Steps 1-3, returns the envelope
+    int32_t filter(const ImuSample& s) {
+        const int16_t raw[6] = {s.ax, s.ay, s.az, s.gx, s.gy, s.gz};
+        int32_t hp[6];
+
+        if (!primed_) {
+            // First sample: start the DC trackers on it, no step response
+            for (size_t a = 0; a < 6; ++a) dc_[a] = static_cast<int32_t>(raw[a]) << 8;
+            primed_ = true;
+        }
+
+        for (size_t a = 0; a < 6; ++a) {
+            const int32_t x = static_cast<int32_t>(raw[a]) << 8;   // Q8
+            dc_[a] += (x - dc_[a]) >> config_.dcShift;
+            hp[a] = (x - dc_[a]) >> 8;
+        }
+
+        const int32_t accel = abs32(hp[0]) + abs32(hp[1]) + abs32(hp[2]);
+        const int32_t gyro = abs32(hp[3]) + abs32(hp[4]) + abs32(hp[5]);
+        const int32_t feature = accel + (gyro >> config_.gyroShift);
+
+        env_ += (feature - env_) >> config_.envShift;
+        return env_;
+    }
+
+    // Steps 4-5
+    bool step(int32_t env, uint32_t t, RipEvent& e) {
+        switch (phase_) {
+            case Phase::SETTLING:
+                if (static_cast<int32_t>(t - lockoutUntilUs_) >= 0 && env < config_.offThreshold) {
+                    phase_ = Phase::ARMED;
+                }
+                return false;
+
+            case Phase::ARMED:
+                if (env >= config_.onThreshold) {
+                    phase_ = Phase::RISING;
+                    onsetUs_ = t;
+                    above_ = 0;
+                    peak_ = 0;
+                    return countAbove(env, t, e);
+                }
+                return false;
+
+            case Phase::RISING:
+                if (env < config_.offThreshold) {
+                    phase_ = Phase::ARMED;   // too short: tap or knock
+                    return false;
+                }
+                return countAbove(env, t, e);
+        }
+        return false;
+    }
+
+    bool countAbove(int32_t env, uint32_t t, RipEvent& e) {
+        if (env > peak_) peak_ = env;
+        if (env >= config_.onThreshold && ++above_ >= config_.confirmSamples) {
+            e.onsetUs = onsetUs_;
+            e.detectedUs = t;
+            e.peak = peak_;
+            e.strength = strength(peak_);
+
+            phase_ = Phase::SETTLING;
+            lockoutUntilUs_ = t + config_.refractoryUs;
+            return true;
+        }
+        return false;
+    }
+
+    uint8_t strength(int32_t peak) const {
+        const int32_t span = config_.fullScale - config_.onThreshold;
+        if (span <= 0 || peak >= config_.fullScale) return 255;
+        if (peak <= config_.onThreshold) return 0;
+        return static_cast<uint8_t>((peak - config_.onThreshold) * 255 / span);
+    }
+
+    RipConfig config_;
+    int32_t dc_[6] = {};
+    int32_t env_ = 0;
+    Phase phase_ = Phase::SETTLING;
+    bool primed_ = false;
+    uint16_t above_ = 0;
+    int32_t peak_ = 0;
+    uint32_t onsetUs_ = 0;
+    uint32_t lockoutUntilUs_ = 0;
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "motion/RipDetector.h"
+
+// =======================================================
+// IMU FIFO -> RipDetector, in bursts
+//
+// Imu is any type providing (see ImuLsm6ds3 on BBLC, or a trace
+// replay on a host build):
+//   bool begin();
+//   uint32_t samplePeriodUs() const;
+//   size_t available();                            // samples in the FIFO
+//   size_t readFifo(ImuSample* out, size_t max);   // burst read, oldest first
+//   bool overrun();                                // FIFO overflowed since last call
+//   uint32_t nowUs();
+//
+// poll() drains the whole FIFO in batches of BATCH samples. The newest
+// sample is taken as captured at the time of the drain, older ones are
+// dated backwards at the sample period.
+// =======================================================
+struct RipPipelineStats {
+    uint32_t batches = 0;
+    uint32_t samples = 0;
+    uint32_t events = 0;
+    uint32_t overruns = 0;
+    uint64_t processUs = 0;   // detector time, all batches
+    uint32_t maxBatchUs = 0;
+
+    uint32_t avgBatchUs() const { return batches ? static_cast<uint32_t>(processUs / batches) : 0; }
+    // Detector cost per sample, in ns
+    uint32_t nsPerSample() const { return samples ? static_cast<uint32_t>(processUs * 1000 / samples) : 0; }
+};
+
+template<typename Imu, size_t BATCH = 16>
+class RipPipeline {
+public:
+    explicit RipPipeline(Imu& imu) : imu_(imu) {}
+
+    bool begin(const RipConfig& config = RipConfig()) {
+        detector_.configure(config);
+        stats_ = RipPipelineStats();
+        ready_ = imu_.begin();
+        return ready_;
+    }
+
+    bool ready() const { return ready_; }
+
+    // Calls onRip(const RipEvent&) for each detection, returns how many.
+    template<typename Fn>
+    size_t poll(Fn onRip) {
+        if (!ready_) return 0;
+
+        if (imu_.overrun()) {
+            // Samples lost: the filters would see a jump, start over
+            ++stats_.overruns;
+            detector_.reset();
+        }
+
+        size_t pending = imu_.available();
+        if (!pending) return 0;
+
+        const uint32_t periodUs = imu_.samplePeriodUs();
+        const uint32_t newestUs = imu_.nowUs();
+        size_t found = 0;
+
+        while (pending) {
+            const size_t n = imu_.readFifo(batch_, pending < BATCH ? pending : BATCH);
+            if (!n) break;
+            pending -= n;
+
+            // Last sample of this batch, `pending` samples before the newest
+            const uint32_t lastUs = newestUs - static_cast<uint32_t>(pending) * periodUs;
+
+            const uint32_t t0 = imu_.nowUs();
+            RipEvent events[MAX_EVENTS];
+            const size_t e = detector_.process(batch_, n, lastUs, periodUs, events, MAX_EVENTS);
+            const uint32_t cost = imu_.nowUs() - t0;
+
+            ++stats_.batches;
+            stats_.samples += static_cast<uint32_t>(n);
+            stats_.processUs += cost;
+            if (cost > stats_.maxBatchUs) stats_.maxBatchUs = cost;
+
+            for (size_t i = 0; i < e; ++i) onRip(events[i]);
+            stats_.events += static_cast<uint32_t>(e);
+            found += e;
+        }
+        return found;
+    }
+
+    const RipDetector& detector() const { return detector_; }
+    const RipPipelineStats& stats() const { return stats_; }
+
+private:
+    // The refractory period allows one event per batch in practice
+    static constexpr size_t MAX_EVENTS = 2;
+
+    Imu& imu_;
+    RipDetector detector_;
+    ImuSample batch_[BATCH];
+    RipPipelineStats stats_;
+    bool ready_ = false;
+};
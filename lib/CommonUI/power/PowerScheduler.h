@@ -0,0 +1,172 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =======================================================
+// Sleep scheduling and energy accounting
+//
+// Pure logic (no Arduino / ESP-IDF dependency): the caller feeds
+// relative deadlines ("next LED frame in 12 ms", "next link sample
+// in 480 ms") and gets back how long to sleep and in which state.
+// Time only enters through arguments, so a host build can drive it
+// from a virtual clock.
+// =======================================================
+
+static constexpr uint32_t POWER_NO_DEADLINE = UINT32_MAX;
+
+enum class PowerState : uint8_t {
+    ACTIVE,        // busy (scan, connect, benchmark...): short polling, no light sleep
+    IDLE,          // CPU idle with clocks running, fast wake
+    LIGHT_SLEEP,   // tickless light sleep, BLE controller in modem sleep
+    COUNT
+};
+
+static constexpr size_t POWER_STATE_COUNT = static_cast<size_t>(PowerState::COUNT);
+
+inline const char* powerStateToString(PowerState state) {
+    switch (state) {
+        case PowerState::ACTIVE:      return "ACTIVE";
+        case PowerState::IDLE:        return "IDLE";
+        case PowerState::LIGHT_SLEEP: return "LIGHT_SLEEP";
+        default:                      return "UNKNOWN";
+    }
+}
+
+struct PowerConfig {
+    uint32_t activePollMs = 10;      // loop period while busy (previous delay(10))
+    uint32_t maxSleepMs = 1000;      // upper bound with no deadline at all
+    uint32_t minLightSleepMs = 5;    // below this, entry/exit cost outweighs the gain
+    uint32_t armedLatencyMs = 50;    // input-to-air budget while armed
+    bool lightSleepEnabled = true;   // false when the build has no PM support
+};
+
+struct PowerDecision {
+    PowerState state = PowerState::ACTIVE;
+    uint32_t sleepMs = 0;
+};
+
+// =========================
+// PowerScheduler
+// =========================
+class PowerScheduler {
+public:
+    void configure(const PowerConfig& config) { config_ = config; }
+    const PowerConfig& config() const { return config_; }
+
+    // One cycle per loop iteration: reset, add every pending deadline, decide.
+    void beginCycle() { nextMs_ = POWER_NO_DEADLINE; }
+
+    void addDeadline(uint32_t inMs) {
+        if (inMs < nextMs_) nextMs_ = inMs;
+    }
+
+    uint32_t nextDeadlineMs() const { return nextMs_; }
+
+    // bleIntervalMs: current connection interval, 0 when not connected.
+    // While armed, a command waits up to one connection interval once the
+    // CPU is awake, so the sleep itself only gets what is left of the budget.
+    PowerDecision decide(bool busy, bool armed, uint32_t bleIntervalMs) const {
+        PowerDecision d;
+        uint32_t sleep = nextMs_ < config_.maxSleepMs ? nextMs_ : config_.maxSleepMs;
+
+        if (busy) {
+            d.state = PowerState::ACTIVE;
+            d.sleepMs = sleep < config_.activePollMs ? sleep : config_.activePollMs;
+            return d;
+        }
+
+        if (armed) {
+            const uint32_t budget = config_.armedLatencyMs > bleIntervalMs
+                ? config_.armedLatencyMs - bleIntervalMs
+                : 0;
+            if (sleep > budget) sleep = budget;
+        }
+
+        d.sleepMs = sleep;
+        d.state = (config_.lightSleepEnabled && sleep >= config_.minLightSleepMs)
+            ? PowerState::LIGHT_SLEEP
+            : PowerState::IDLE;
+        return d;
+    }
+
+private:
+    PowerConfig config_;
+    uint32_t nextMs_ = POWER_NO_DEADLINE;
+};
+
+// =========================
+// EnergyModel
+// =========================
+// Integrates time spent per power state into an estimated charge.
+// Currents are datasheet-level figures, good enough to compare
+// configurations, not to replace a real measurement.
+struct PowerProfile {
+    uint32_t stateUa[POWER_STATE_COUNT] = {
+        22000,   // ACTIVE: CPU at full clock, radio idle
+        8000,    // IDLE: CPU waiting, clocks and peripherals on
+        250,     // LIGHT_SLEEP: modem sleep, RTC timer running
+    };
+    uint32_t bleEventUaMs = 30;   // one connection event (~2 ms RX/TX at ~15 mA)
+};
+
+class EnergyModel {
+public:
+    void configure(const PowerProfile& profile) { profile_ = profile; }
+
+    void reset() {
+        for (size_t i = 0; i < POWER_STATE_COUNT; ++i) {
+            timeMs_[i] = 0;
+            entries_[i] = 0;
+        }
+        bleEvents_ = 0;
+        chargeUaMs_ = 0;
+    }
+
+    // bleIntervalMs: connection events that happened meanwhile, 0 when idle.
+    void account(PowerState state, uint32_t ms, uint32_t bleIntervalMs) {
+        const size_t i = static_cast<size_t>(state);
+        if (i >= POWER_STATE_COUNT) return;
+
+        timeMs_[i] += ms;
+        ++entries_[i];
+        chargeUaMs_ += static_cast<uint64_t>(profile_.stateUa[i]) * ms;
+
+        if (bleIntervalMs) {
+            const uint32_t events = ms / bleIntervalMs;
+            bleEvents_ += events;
+            chargeUaMs_ += static_cast<uint64_t>(profile_.bleEventUaMs) * events;
+        }
+    }
+
+    uint64_t timeMs(PowerState state) const { return timeMs_[static_cast<size_t>(state)]; }
+    uint32_t entries(PowerState state) const { return entries_[static_cast<size_t>(state)]; }
+    uint64_t bleEvents() const { return bleEvents_; }
+
+    uint64_t totalMs() const {
+        uint64_t t = 0;
+        for (size_t i = 0; i < POWER_STATE_COUNT; ++i) t += timeMs_[i];
+        return t;
+    }
+
+    // Share of time in a state, in per mille.
+    uint32_t permille(PowerState state) const {
+        const uint64_t total = totalMs();
+        return total ? static_cast<uint32_t>(timeMs(state) * 1000u / total) : 0;
+    }
+
+    uint32_t averageUa() const {
+        const uint64_t total = totalMs();
+        return total ? static_cast<uint32_t>(chargeUaMs_ / total) : 0;
+    }
+
+    // 1 uAh = 3 600 000 uA.ms
+    uint32_t chargeUah() const { return static_cast<uint32_t>(chargeUaMs_ / 3600000u); }
+
+private:
+    PowerProfile profile_;
+    uint64_t timeMs_[POWER_STATE_COUNT] = {};
+    uint32_t entries_[POWER_STATE_COUNT] = {};
+    uint64_t bleEvents_ = 0;
+    uint64_t chargeUaMs_ = 0;
+};
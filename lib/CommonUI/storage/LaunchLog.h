@@ -0,0 +1,430 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// =======================================================
+// Append-only launch history on raw flash
+//
+// The partition is a ring of erase sectors. Each sector starts
+// with a small header (magic, sector sequence, first record seq)
+// followed by fixed-size records written strictly in order.
+//
+// - Append is O(1): one record write. The next sector is erased
+//   ahead of time by maintain(), so the launch path never waits
+//   for an erase in steady state.
+// - Wear levelling comes from the ring: every sector is erased
+//   once per lap.
+// - Crash safety: records and headers carry a CRC. A torn record
+//   is skipped, a torn rotation leaves a headerless sector that
+//   recovery ignores. Recovery reads every header once, then
+//   binary-searches the write position in the newest sector and
+//   scans past it, since a failed append can leave an erased slot
+//   behind programmed ones.
+//
+// `Flash` is duck-typed so the same code runs on an ESP partition
+// or a file-backed simulator on a host:
+//   size_t size() const;  size_t sectorSize() const;
+//   bool read(uint32_t addr, void* dst, size_t len);
+//   bool write(uint32_t addr, const void* src, size_t len);
+//   bool eraseSector(uint32_t index);
+//
+// Records are stored in native (little-endian) byte order.
+// =======================================================
+
+struct LaunchRecord {
+    uint32_t seq;           // global, monotonic (filled by append)
+    uint32_t timestampMs;   // millis() at fire time
+    uint32_t latencyUs;     // command received -> fire edge, 0 when unknown (no fire output yet)
+    uint16_t bootCount;     // boot session, filled by append
+    uint16_t rpm;           // measured RPM, 0 when unknown
+    uint8_t profile;
+    uint8_t flags;
+    uint16_t reserved;
+    uint32_t crc;           // CRC32 of the previous fields
+};
+
+static_assert(sizeof(LaunchRecord) == 24, "LaunchRecord is a flash/wire format");
+
+static constexpr size_t LAUNCH_RECORD_SIZE = sizeof(LaunchRecord);
+
+// LaunchRecord::flags
+static constexpr uint8_t LAUNCH_FLAG_GESTURE = 0x01;   // fired by a BBLC motion gesture
+
+// CRC-32 (IEEE, reflected), bitwise: records are tiny.
+inline uint32_t launchLogCrc32(const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t crc = 0xFFFFFFFFu;
+    while (len--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+inline uint32_t launchRecordCrc(const LaunchRecord& r) {
+    return launchLogCrc32(&r, offsetof(LaunchRecord, crc));
+}
+
+inline bool launchRecordValid(const LaunchRecord& r) {
+    return r.seq != 0xFFFFFFFFu && r.crc == launchRecordCrc(r);
+}
+
+template<typename Flash>
+class LaunchLog {
+public:
+    static constexpr uint32_t MAGIC = 0x4C4C4242;   // "BBLL"
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t HEADER_SPACE = 32;      // header + padding
+
+    // Export position, see oldest() / readBatch()
+    struct Cursor {
+        uint32_t sector;
+        uint32_t slot;
+        uint32_t sectorsLeft;
+    };
+
+    explicit LaunchLog(Flash& flash) : flash_(flash) {}
+
+    // Recovers the write position, formats an empty partition.
+    bool begin() {
+        sectorCount_ = static_cast<uint32_t>(flash_.size() / flash_.sectorSize());
+        slotsPerSector_ = static_cast<uint32_t>((flash_.sectorSize() - HEADER_SPACE) / LAUNCH_RECORD_SIZE);
+        ready_ = false;
+
+        if (sectorCount_ < 2 || slotsPerSector_ == 0) {
+            return false;
+        }
+
+        bool found = false;
+        uint32_t maxSeq = 0;
+        uint32_t minSeq = 0;
+
+        for (uint32_t s = 0; s < sectorCount_; ++s) {
+            SectorHeader h;
+            if (!readHeader(s, h)) continue;
+
+            if (!found || h.sectorSeq > maxSeq) {
+                maxSeq = h.sectorSeq;
+                headSector_ = s;
+                headFirstSeq_ = h.firstSeq;
+            }
+            if (!found || h.sectorSeq < minSeq) {
+                minSeq = h.sectorSeq;
+                tailSector_ = s;
+            }
+            found = true;
+        }
+
+        preErased_ = NONE;
+
+        if (!found) {
+            nextSeq_ = 0;
+            bootCount_ = 0;
+            if (!openSector(0, 0, 0)) return false;
+            tailSector_ = 0;
+            ready_ = true;
+            return true;
+        }
+
+        headSectorSeq_ = maxSeq;
+        headSlot_ = findWriteSlot(headSector_);
+
+        LaunchRecord last;
+        if (findLastValid(last)) {
+            nextSeq_ = last.seq + 1;
+            bootCount_ = static_cast<uint16_t>(last.bootCount + 1);
+        } else {
+            nextSeq_ = headFirstSeq_;
+            bootCount_ = 0;
+        }
+
+        ready_ = true;
+        return true;
+    }
+
+    bool ready() const { return ready_; }
+
+    // O(1): writes one record at the head. seq, bootCount and crc are filled here.
+    bool append(LaunchRecord& record) {
+        if (!ready_) return false;
+
+        if (headSlot_ >= slotsPerSector_ && !rotate()) {
+            return false;
+        }
+
+        record.seq = nextSeq_;
+        record.bootCount = bootCount_;
+        record.crc = launchRecordCrc(record);
+
+        const uint32_t addr = slotAddr(headSector_, headSlot_);
+        const bool ok = flash_.write(addr, &record, LAUNCH_RECORD_SIZE);
+
+        // Slot consumed even on failure: flash cannot be rewritten without
+        // erase. Program it to zeros (invalid CRC) so it does not read back
+        // as erased; recovery copes if this fails too.
+        if (!ok) {
+            static const uint8_t zeros[LAUNCH_RECORD_SIZE] = {};
+            flash_.write(addr, zeros, sizeof(zeros));
+        }
+        ++headSlot_;
+        if (ok) ++nextSeq_;
+        return ok;
+    }
+
+    // Background work, call from the main loop: erases the next sector
+    // once the head sector is 3/4 full.
+    void maintain() {
+        if (!ready_ || headSlot_ < (slotsPerSector_ * 3) / 4) {
+            return;
+        }
+
+        const uint32_t next = (headSector_ + 1) % sectorCount_;
+        if (preErased_ == next) {
+            return;
+        }
+
+        if (flash_.eraseSector(next)) {
+            preErased_ = next;
+            if (next == tailSector_) advanceTail();
+        }
+    }
+
+    // Cursor on the oldest record still in the ring.
+    Cursor oldest() const {
+        Cursor c;
+        c.sector = tailSector_;
+        c.slot = 0;
+        c.sectorsLeft = ready_ ? ((headSector_ + sectorCount_ - tailSector_) % sectorCount_) + 1 : 0;
+        return c;
+    }
+
+    bool exhausted(const Cursor& c) const { return c.sectorsLeft == 0; }
+
+    // Copies up to `max` valid records, oldest first. Contiguous slots are
+    // fetched with a single flash read; torn records are dropped.
+    size_t readBatch(Cursor& c, LaunchRecord* out, size_t max) {
+        size_t count = 0;
+
+        while (count < max && c.sectorsLeft > 0) {
+            const bool isHead = c.sector == headSector_;
+            const uint32_t end = isHead ? headSlot_ : slotsPerSector_;
+
+            if (c.slot >= end) {
+                if (isHead) {
+                    c.sectorsLeft = 0;   // caught up with the writer
+                } else {
+                    nextSector(c);
+                }
+                continue;
+            }
+
+            SectorHeader h;
+            if (c.slot == 0 && !isHead && !readHeader(c.sector, h)) {
+                nextSector(c);
+                continue;
+            }
+
+            uint32_t n = end - c.slot;
+            if (n > max - count) n = static_cast<uint32_t>(max - count);
+
+            if (!flash_.read(slotAddr(c.sector, c.slot), out + count, n * LAUNCH_RECORD_SIZE)) {
+                nextSector(c);
+                continue;
+            }
+
+            c.slot += n;
+            count += compact(out + count, n);
+        }
+
+        return count;
+    }
+
+    uint32_t nextSeq() const { return nextSeq_; }
+    uint16_t bootCount() const { return bootCount_; }
+    size_t capacity() const { return static_cast<size_t>(sectorCount_ - 1) * slotsPerSector_; }
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    struct SectorHeader {
+        uint32_t magic;
+        uint32_t sectorSeq;
+        uint32_t firstSeq;
+        uint8_t version;
+        uint8_t recordSize;
+        uint16_t reserved;
+        uint32_t crc;
+    };
+
+    static_assert(sizeof(SectorHeader) <= HEADER_SPACE, "header overflows its space");
+
+    uint32_t slotAddr(uint32_t sector, uint32_t slot) const {
+        return static_cast<uint32_t>(sector * flash_.sectorSize() + HEADER_SPACE + slot * LAUNCH_RECORD_SIZE);
+    }
+
+    bool readHeader(uint32_t sector, SectorHeader& h) {
+        if (!flash_.read(static_cast<uint32_t>(sector * flash_.sectorSize()), &h, sizeof(h))) {
+            return false;
+        }
+        return h.magic == MAGIC &&
+               h.version == VERSION &&
+               h.recordSize == LAUNCH_RECORD_SIZE &&
+               h.crc == launchLogCrc32(&h, offsetof(SectorHeader, crc));
+    }
+
+    bool openSector(uint32_t sector, uint32_t sectorSeq, uint32_t firstSeq) {
+        if (preErased_ != sector && !flash_.eraseSector(sector)) {
+            return false;
+        }
+        preErased_ = NONE;
+
+        SectorHeader h;
+        memset(&h, 0xFF, sizeof(h));
+        h.magic = MAGIC;
+        h.sectorSeq = sectorSeq;
+        h.firstSeq = firstSeq;
+        h.version = VERSION;
+        h.recordSize = LAUNCH_RECORD_SIZE;
+        h.reserved = 0xFFFF;
+        h.crc = launchLogCrc32(&h, offsetof(SectorHeader, crc));
+
+        if (!flash_.write(static_cast<uint32_t>(sector * flash_.sectorSize()), &h, sizeof(h))) {
+            return false;
+        }
+
+        headSector_ = sector;
+        headSectorSeq_ = sectorSeq;
+        headFirstSeq_ = firstSeq;
+        headSlot_ = 0;
+        return true;
+    }
+
+    bool rotate() {
+        const uint32_t next = (headSector_ + 1) % sectorCount_;
+        if (next == tailSector_) {
+            advanceTail();   // oldest sector is about to be recycled
+        }
+        return openSector(next, headSectorSeq_ + 1, nextSeq_);
+    }
+
+    // Moves the tail to the next sector that still holds a valid header.
+    void advanceTail() {
+        for (;;) {
+            tailSector_ = (tailSector_ + 1) % sectorCount_;
+            SectorHeader h;
+            if (tailSector_ == headSector_ ||
+                (tailSector_ != preErased_ && readHeader(tailSector_, h))) {
+                return;
+            }
+        }
+    }
+
+    static bool bytesErased(const uint8_t* p, size_t len) {
+        for (size_t i = 0; i < len; ++i) {
+            if (p[i] != 0xFF) return false;
+        }
+        return true;
+    }
+
+    bool slotErased(uint32_t sector, uint32_t slot) {
+        uint8_t raw[LAUNCH_RECORD_SIZE];
+        if (!flash_.read(slotAddr(sector, slot), raw, sizeof(raw))) {
+            return false;
+        }
+        return bytesErased(raw, sizeof(raw));
+    }
+
+    // Slots are programmed in order, so "erased" is monotonic and a binary
+    // search finds the write position in a few reads. A failed append can
+    // still leave an erased slot behind programmed ones (power loss before
+    // the zero fill): the search may stop in that gap, so the rest of the
+    // sector is scanned and writing resumes after the last programmed slot.
+    uint32_t findWriteSlot(uint32_t sector) {
+        uint32_t lo = 0;
+        uint32_t hi = slotsPerSector_;
+        while (lo < hi) {
+            const uint32_t mid = lo + (hi - lo) / 2;
+            if (slotErased(sector, mid)) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+
+        static constexpr uint32_t CHUNK = 8;
+        uint8_t raw[CHUNK * LAUNCH_RECORD_SIZE];
+        uint32_t end = lo;
+        for (uint32_t slot = lo; slot < slotsPerSector_; slot += CHUNK) {
+            const uint32_t n = slotsPerSector_ - slot < CHUNK ? slotsPerSector_ - slot : CHUNK;
+            if (!flash_.read(slotAddr(sector, slot), raw, n * LAUNCH_RECORD_SIZE)) {
+                return slotsPerSector_;   // unreadable: never write over it
+            }
+            for (uint32_t i = 0; i < n; ++i) {
+                if (!bytesErased(raw + i * LAUNCH_RECORD_SIZE, LAUNCH_RECORD_SIZE)) {
+                    end = slot + i + 1;
+                }
+            }
+        }
+        return end;
+    }
+
+    // Last valid record in the head sector, or in the one before it.
+    bool findLastValid(LaunchRecord& out) {
+        if (scanBack(headSector_, headSlot_, out)) {
+            return true;
+        }
+
+        const uint32_t prev = (headSector_ + sectorCount_ - 1) % sectorCount_;
+        SectorHeader h;
+        if (prev != headSector_ && readHeader(prev, h) && h.sectorSeq + 1 == headSectorSeq_) {
+            return scanBack(prev, slotsPerSector_, out);
+        }
+        return false;
+    }
+
+    bool scanBack(uint32_t sector, uint32_t endSlot, LaunchRecord& out) {
+        for (uint32_t slot = endSlot; slot > 0; --slot) {
+            if (flash_.read(slotAddr(sector, slot - 1), &out, LAUNCH_RECORD_SIZE) &&
+                launchRecordValid(out)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void nextSector(Cursor& c) {
+        c.sector = (c.sector + 1) % sectorCount_;
+        c.slot = 0;
+        --c.sectorsLeft;
+    }
+
+    static size_t compact(LaunchRecord* records, size_t n) {
+        size_t kept = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (launchRecordValid(records[i])) {
+                if (kept != i) records[kept] = records[i];
+                ++kept;
+            }
+        }
+        return kept;
+    }
+
+    Flash& flash_;
+    uint32_t sectorCount_ = 0;
+    uint32_t slotsPerSector_ = 0;
+
+    uint32_t headSector_ = 0;
+    uint32_t headSectorSeq_ = 0;
+    uint32_t headFirstSeq_ = 0;
+    uint32_t headSlot_ = 0;
+    uint32_t tailSector_ = 0;
+    uint32_t preErased_ = NONE;
+
+    uint32_t nextSeq_ = 0;
+    uint16_t bootCount_ = 0;
+    bool ready_ = false;
+};
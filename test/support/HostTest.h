@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+
+// =======================================================
+// Minimal host test support
+//
+// The CommonUI headers have no Arduino dependency, so they
+// are exercised here with plain g++. A failed CHECK reports
+// and keeps going; the test binary exits non-zero if any
+// check failed. Benchmarks print one "BENCH" line each.
+// =======================================================
+
+namespace HostTest {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void fail(const char* file, int line, const char* expr) {
+    fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expr);
+    ++failures();
+}
+
+inline void failEq(const char* file, int line, const char* a, const char* b,
+                   long long va, long long vb) {
+    fprintf(stderr, "%s:%d: CHECK_EQ failed: %s (%lld) != %s (%lld)\n",
+            file, line, a, va, b, vb);
+    ++failures();
+}
+
+template <typename Fn>
+void run(const char* name, Fn fn) {
+    const int before = failures();
+    fn();
+    printf("[%s] %s\n", failures() == before ? " OK " : "FAIL", name);
+}
+
+inline int result() {
+    if (failures()) {
+        fprintf(stderr, "%d check(s) failed\n", failures());
+    }
+    return failures() ? 1 : 0;
+}
+
+// Wall clock for the benchmarks, in microseconds.
+inline uint64_t nowUs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// xorshift32, same generator as the on-target synthetic traces.
+class Rng {
+public:
+    explicit Rng(uint32_t seed) : state_(seed ? seed : 1) {}
+
+    uint32_t next() {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_;
+    }
+
+    // Uniform in [lo, hi].
+    int32_t range(int32_t lo, int32_t hi) {
+        return lo + static_cast<int32_t>(next() % static_cast<uint32_t>(hi - lo + 1));
+    }
+
+    bool oneIn(uint32_t n) { return n <= 1 || next() % n == 0; }
+
+private:
+    uint32_t state_;
+};
+
+} // namespace HostTest
+
+#define CHECK(cond) \
+    do { if (!(cond)) HostTest::fail(__FILE__, __LINE__, #cond); } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        const long long va_ = static_cast<long long>(a); \
+        const long long vb_ = static_cast<long long>(b); \
+        if (va_ != vb_) HostTest::failEq(__FILE__, __LINE__, #a, #b, va_, vb_); \
+    } while (0)
+
+#define RUN_TEST(fn) HostTest::run(#fn, fn)
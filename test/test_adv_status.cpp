@@ -0,0 +1,209 @@
+// Advertised head status: codec, parser robustness and a crowded-room
+// flood benchmark of the in-place parser.
+
+#include "HostTest.h"
+
+#include <vector>
+
+#include "ble/AdvStatus.h"
+
+namespace {
+
+using Payload = std::vector<uint8_t>;
+
+void addField(Payload& p, uint8_t type, const uint8_t* data, size_t len) {
+    p.push_back(static_cast<uint8_t>(len + 1));
+    p.push_back(type);
+    p.insert(p.end(), data, data + len);
+}
+
+// Primary advertisement exactly as BBLH builds it: flags, 128-bit UUID, status.
+Payload headAdvertisement(const AdvStatus& s) {
+    Payload p;
+    const uint8_t flags = 0x06;
+    addField(p, 0x01, &flags, 1);
+    uint8_t uuid[16];
+    for (int i = 0; i < 16; ++i) uuid[i] = static_cast<uint8_t>(0x10 + i);
+    addField(p, 0x07, uuid, sizeof(uuid));
+    uint8_t record[AdvStatusFormat::DATA_SIZE];
+    encodeAdvStatus(s, record);
+    addField(p, AdvStatusFormat::AD_TYPE_MANUFACTURER, record, sizeof(record));
+    return p;
+}
+
+void testRoundTrip() {
+    for (uint8_t flags = 0; flags < 32; ++flags) {
+        AdvStatus s;
+        s.flags = flags;
+        s.batteryPct = static_cast<uint8_t>(flags * 3);
+        s.fwMajor = 1;
+        s.fwMinor = 7;
+        s.seq = static_cast<uint8_t>(200 + flags);
+        const Payload p = headAdvertisement(s);
+
+        AdvStatus out;
+        CHECK(parseAdvStatus(p.data(), p.size(), out));
+        CHECK_EQ(out.flags, s.flags);
+        CHECK_EQ(out.batteryPct, s.batteryPct);
+        CHECK_EQ(out.fwMajor, 1);
+        CHECK_EQ(out.fwMinor, 7);
+        CHECK_EQ(out.seq, s.seq);
+    }
+}
+
+// The payload budget that forced the Appearance field out.
+void testPrimaryPayloadBudget() {
+    const Payload p = headAdvertisement(AdvStatus());
+    CHECK_EQ(p.size(), AdvStatusFormat::PRIMARY_USED);
+    CHECK(p.size() <= AdvStatusFormat::ADV_PAYLOAD_MAX);
+    // Appearance AD = length + type + u16
+    CHECK(p.size() + 4 > AdvStatusFormat::ADV_PAYLOAD_MAX);
+}
+
+void testRejectsForeignAndMalformed() {
+    AdvStatus out;
+
+    // Another company, or our company with a foreign tag / version
+    uint8_t apple[] = {0x4C, 0x00, 0x02, 0x15, 1, 2, 3, 4};
+    Payload p;
+    addField(p, 0xFF, apple, sizeof(apple));
+    CHECK(!parseAdvStatus(p.data(), p.size(), out));
+
+    uint8_t record[AdvStatusFormat::DATA_SIZE];
+    encodeAdvStatus(AdvStatus(), record);
+    record[2] = AdvStatusFormat::TAG | (AdvStatusFormat::VERSION + 1);
+    p.clear();
+    addField(p, 0xFF, record, sizeof(record));
+    CHECK(!parseAdvStatus(p.data(), p.size(), out));
+
+    // Record too short
+    encodeAdvStatus(AdvStatus(), record);
+    p.clear();
+    addField(p, 0xFF, record, 5);
+    CHECK(!parseAdvStatus(p.data(), p.size(), out));
+
+    // Truncated: the last field claims more bytes than received
+    Payload full = headAdvertisement(AdvStatus());
+    for (size_t cut = 0; cut < full.size(); ++cut) {
+        CHECK(!parseAdvStatus(full.data(), cut, out));
+    }
+
+    // Zero-length padding stops the walk
+    Payload padded = {0x00, 0x00};
+    padded.insert(padded.end(), full.begin(), full.end());
+    CHECK(!parseAdvStatus(padded.data(), padded.size(), out));
+
+    CHECK(!parseAdvStatus(nullptr, 0, out));
+}
+
+// Status behind a foreign manufacturer record and the scan response name.
+void testFoundAfterOtherFields() {
+    Payload p;
+    const char name[] = "BBLH";
+    addField(p, 0x09, reinterpret_cast<const uint8_t*>(name), 4);
+    uint8_t other[] = {0x59, 0x00, 0xAA};
+    addField(p, 0xFF, other, sizeof(other));
+    AdvStatus s;
+    s.seq = 42;
+    uint8_t record[AdvStatusFormat::DATA_SIZE];
+    encodeAdvStatus(s, record);
+    addField(p, 0xFF, record, sizeof(record));
+
+    AdvStatus out;
+    CHECK(parseAdvStatus(p.data(), p.size(), out));
+    CHECK_EQ(out.seq, 42);
+}
+
+// Random bytes: never accepted by accident, never read past the end.
+void testFuzz() {
+    HostTest::Rng rng(77);
+    uint32_t accepted = 0;
+    for (int i = 0; i < 200000; ++i) {
+        const size_t len = static_cast<size_t>(rng.range(0, 31));
+        Payload p(len);
+        for (auto& b : p) b = static_cast<uint8_t>(rng.next());
+        AdvStatus out;
+        if (parseAdvStatus(p.data(), p.size(), out)) ++accepted;
+    }
+    CHECK_EQ(accepted, 0);
+}
+
+// Crowded room: many foreign advertisers (beacons, phones, trackers) and a
+// few heads, each advertising every 100 ms for 10 s. Every head update must
+// be seen, nothing foreign accepted, and the parse cost stays far below the
+// per-report budget of the scan callback.
+void benchFlood() {
+    static constexpr int HEADS = 12;
+    static constexpr int FOREIGN = 300;
+    HostTest::Rng rng(2024);
+
+    std::vector<Payload> foreign;
+    for (int i = 0; i < FOREIGN; ++i) {
+        Payload p;
+        const uint8_t flags = 0x1A;
+        addField(p, 0x01, &flags, 1);
+        const int fields = rng.range(1, 3);
+        for (int f = 0; f < fields && p.size() < 24; ++f) {
+            uint8_t data[12];
+            const size_t n = static_cast<size_t>(rng.range(2, 8));
+            for (size_t k = 0; k < n; ++k) data[k] = static_cast<uint8_t>(rng.next());
+            const uint8_t types[] = {0xFF, 0x16, 0x03, 0x09, 0x0A};
+            addField(p, types[rng.next() % 5], data, n);
+        }
+        foreign.push_back(p);
+    }
+
+    AdvStatus heads[HEADS];
+    uint8_t lastSeen[HEADS] = {};
+    uint32_t updates = 0;
+    uint32_t seenUpdates = 0;
+    uint32_t reports = 0;
+    uint32_t accepted = 0;
+
+    uint64_t parseUs = 0;
+    for (int tick = 0; tick < 100; ++tick) {   // 10 s of 100 ms advertising events
+        for (int h = 0; h < HEADS; ++h) {
+            if (rng.oneIn(10)) {
+                heads[h].flags ^= AdvStatusFlag::ARMED;
+                ++heads[h].seq;
+                ++updates;
+            }
+        }
+
+        std::vector<std::pair<int, Payload>> air;
+        for (int h = 0; h < HEADS; ++h) air.push_back({h, headAdvertisement(heads[h])});
+        for (int f = 0; f < FOREIGN; ++f) air.push_back({-1, foreign[f]});
+
+        const uint64_t t0 = HostTest::nowUs();
+        for (const auto& a : air) {
+            AdvStatus out;
+            const bool ok = parseAdvStatus(a.second.data(), a.second.size(), out);
+            ++reports;
+            if (!ok) continue;
+            ++accepted;
+            if (a.first >= 0) {
+                seenUpdates += static_cast<uint8_t>(out.seq - lastSeen[a.first]);
+                lastSeen[a.first] = out.seq;
+            }
+        }
+        parseUs += HostTest::nowUs() - t0;
+    }
+
+    CHECK_EQ(accepted, HEADS * 100);
+    CHECK_EQ(seenUpdates, updates);
+    printf("BENCH adv flood: %lu reports (%d heads, %d foreign) parsed in %lu us, %.1f ns/report, %lu status changes seen\n",
+           (unsigned long)reports, HEADS, FOREIGN, (unsigned long)parseUs,
+           parseUs * 1000.0 / reports, (unsigned long)seenUpdates);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testRoundTrip);
+    RUN_TEST(testPrimaryPayloadBudget);
+    RUN_TEST(testRejectsForeignAndMalformed);
+    RUN_TEST(testFoundAfterOtherFields);
+    RUN_TEST(testFuzz);
+    RUN_TEST(benchFlood);
+    return HostTest::result();
+}
@@ -0,0 +1,175 @@
+// Throughput benchmark codecs and sessions over the in-process loopback.
+
+#include "HostTest.h"
+
+#include "ble/BleBenchmark.h"
+
+namespace {
+
+void testLittleEndianHelpers() {
+    uint8_t buf[4];
+    BleProto::putU32(buf, 0x12345678u);
+    CHECK_EQ(buf[0], 0x78);
+    CHECK_EQ(buf[3], 0x12);
+    CHECK_EQ(BleProto::getU32(buf), 0x12345678u);
+    BleProto::putU16(buf, 0xBEEF);
+    CHECK_EQ(BleProto::getU16(buf), 0xBEEF);
+}
+
+void testConfigAndReportRoundTrip() {
+    BleBench::Config c;
+    c.direction = BleBench::Direction::NOTIFY;
+    c.writeType = BleBench::WriteType::WITH_RESPONSE;
+    c.phy = 2;
+    c.payloadSize = 244;
+    c.durationMs = 1500;
+
+    uint8_t raw[BleBench::CONFIG_SIZE];
+    memset(raw, 0xEE, sizeof(raw));
+    BleBench::encodeConfig(c, raw);
+    CHECK_EQ(raw[3], 0);
+    CHECK_EQ(BleProto::getU16(raw + 6), 0);   // reserved, the MTU is the link's
+
+    BleBench::Config d;
+    CHECK(BleBench::decodeConfig(raw, sizeof(raw), d));
+    CHECK(d.direction == c.direction);
+    CHECK(d.writeType == c.writeType);
+    CHECK_EQ(d.phy, 2);
+    CHECK_EQ(d.payloadSize, 244);
+    CHECK_EQ(d.durationMs, 1500);
+    CHECK(!BleBench::decodeConfig(raw, sizeof(raw) - 1, d));
+
+    BleBench::Report r;
+    r.role = BleBench::Role::SERVER;
+    r.effectiveMtu = 247;
+    r.config = c;
+    r.stats.opsOk = 1000;
+    r.stats.opsFailed = 3;
+    r.stats.bytesSent = 244000;
+    r.stats.cpuUs = 51234;
+    r.stats.elapsedMs = 1500;
+    r.stats.rxFrames = 990;
+    r.stats.rxBytes = 241560;
+    r.stats.rxLost = 10;
+
+    uint8_t rep[BleBench::REPORT_SIZE];
+    BleBench::encodeReport(r, rep);
+    BleBench::Report q;
+    CHECK(BleBench::decodeReport(rep, sizeof(rep), q));
+    CHECK(q.role == BleBench::Role::SERVER);
+    CHECK_EQ(q.effectiveMtu, 247);
+    CHECK_EQ(q.config.payloadSize, 244);
+    CHECK_EQ(q.stats.opsOk, 1000);
+    CHECK_EQ(q.stats.opsFailed, 3);
+    CHECK_EQ(q.stats.bytesSent, 244000);
+    CHECK_EQ(q.stats.cpuUs, 51234);
+    CHECK_EQ(q.stats.rxFrames, 990);
+    CHECK_EQ(q.stats.rxBytes, 241560);
+    CHECK_EQ(q.stats.rxLost, 10);
+    CHECK_EQ(q.stats.goodputBps(), 161040);
+
+    rep[0] = BleBench::REPORT_VERSION + 1;
+    CHECK(!BleBench::decodeReport(rep, sizeof(rep), q));
+}
+
+void testPayloadClampedToMtu() {
+    BleBench::Config c;
+    c.payloadSize = 244;
+    BleBench::Session s;
+    s.start(c, 0, 20);   // default 23-byte MTU
+    CHECK_EQ(s.config().payloadSize, 20);
+    c.payloadSize = 1;
+    s.start(c, 0, 244);
+    CHECK_EQ(s.config().payloadSize, BleBench::DATA_HEADER_SIZE);
+}
+
+// Sender floods a bounded loopback drained a few frames per "connection
+// event": refused sends are not losses, frames dropped in flight are.
+void testLoopbackAccounting() {
+    BleBench::Config c;
+    c.payloadSize = 64;
+    c.durationMs = 1000;
+
+    BleBench::Session tx;
+    BleBench::Session rx;
+    BleBench::Loopback<16, 256> link;
+    tx.start(c, 0, 244);
+    rx.start(c, 0, 244);
+
+    uint8_t frame[256];
+    uint32_t dropped = 0;
+    for (uint32_t now = 0; tx.sending(now); ++now) {
+        for (int burst = 0; burst < 8; ++burst) {
+            const size_t len = tx.nextFrame(frame);
+            // Every 50th accepted frame is corrupted by the "radio".
+            const bool lose = (tx.stats().opsOk % 50) == 49;
+            const bool ok = lose ? true : link.send(frame, len);
+            if (lose) ++dropped;
+            tx.recordSend(ok, len, 1);
+        }
+        link.deliver(rx, 4);
+    }
+    link.deliver(rx, 64);
+    tx.stop(1000);
+    rx.stop(1000);
+
+    const BleBench::Stats& ts = tx.stats();
+    const BleBench::Stats& rs = rx.stats();
+    CHECK(ts.opsFailed > 0);                         // loopback saturated
+    CHECK_EQ(ts.opsOk, rs.rxFrames + dropped);
+    CHECK_EQ(rs.rxLost, dropped);
+    CHECK_EQ(rs.rxBytes, rs.rxFrames * 64u);
+    CHECK_EQ(ts.elapsedMs, 1000);
+    printf("BENCH loopback sent=%lu refused=%lu received=%lu lost=%lu goodput=%lu B/s\n",
+           (unsigned long)ts.opsOk, (unsigned long)ts.opsFailed,
+           (unsigned long)rs.rxFrames, (unsigned long)rs.rxLost,
+           (unsigned long)rs.goodputBps());
+}
+
+void testOverdue() {
+    BleBench::Config c;
+    c.durationMs = 100;
+    BleBench::Session s;
+    s.start(c, 1000, 244);
+    CHECK(s.sending(1099));
+    CHECK(!s.sending(1100));
+    CHECK(!s.overdue(1100 + 499, 500));
+    CHECK(s.overdue(1100 + 500, 500));
+    s.stop(1200);
+    CHECK(!s.overdue(5000, 500));
+}
+
+// Host cost of building and accounting frames, i.e. the CPU overhead the
+// firmware adds on top of the NimBLE calls.
+void benchFrameCodec() {
+    BleBench::Config c;
+    c.payloadSize = 244;
+    BleBench::Session tx;
+    BleBench::Session rx;
+    tx.start(c, 0, 244);
+    rx.start(c, 0, 244);
+    uint8_t frame[256];
+    const uint32_t n = 200000;
+    const uint64_t t0 = HostTest::nowUs();
+    for (uint32_t i = 0; i < n; ++i) {
+        const size_t len = tx.nextFrame(frame);
+        tx.recordSend(true, len, 0);
+        rx.onFrame(frame, len);
+    }
+    const uint64_t dt = HostTest::nowUs() - t0;
+    CHECK_EQ(rx.stats().rxFrames, n);
+    CHECK_EQ(rx.stats().rxLost, 0);
+    printf("BENCH frame codec 244 B: %.1f ns/frame\n", dt * 1000.0 / n);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testLittleEndianHelpers);
+    RUN_TEST(testConfigAndReportRoundTrip);
+    RUN_TEST(testPayloadClampedToMtu);
+    RUN_TEST(testLoopbackAccounting);
+    RUN_TEST(testOverdue);
+    RUN_TEST(benchFrameCodec);
+    return HostTest::result();
+}
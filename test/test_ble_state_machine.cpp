@@ -0,0 +1,370 @@
+// BLE state machine: the client and server graphs edge by edge, every
+// timeout path, dwell statistics, and the host task -> loop event queue.
+
+#include "HostTest.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "ble/BleStateMachine.h"
+
+namespace {
+
+using S = BleState;
+using E = BleEvent;
+
+struct Edge {
+    S from;
+    E event;
+    S to;
+};
+
+// The graphs as documented in the README, TIMEOUT edges included.
+const std::vector<Edge> CLIENT_EDGES = {
+    {S::BOOT,         E::START,       S::SCANNING},
+    {S::SCANNING,     E::START,       S::SCANNING},
+    {S::SCANNING,     E::PEER_FOUND,  S::CONNECTING},
+    {S::SCANNING,     E::LINK_FAILED, S::DISCONNECTED},
+    {S::CONNECTING,   E::LINK_UP,     S::CONNECTED},
+    {S::CONNECTING,   E::LINK_FAILED, S::DISCONNECTED},
+    {S::CONNECTING,   E::FAULT,       S::ERROR},
+    {S::CONNECTING,   E::LINK_LOST,   S::DISCONNECTED},
+    {S::CONNECTING,   E::TIMEOUT,     S::ERROR},
+    {S::CONNECTED,    E::LINK_LOST,   S::DISCONNECTED},
+    {S::DISCONNECTED, E::START,       S::SCANNING},
+    {S::DISCONNECTED, E::TIMEOUT,     S::SCANNING},
+    {S::ERROR,        E::START,       S::SCANNING},
+    {S::ERROR,        E::TIMEOUT,     S::SCANNING},
+};
+
+const std::vector<Edge> SERVER_EDGES = {
+    {S::BOOT,         E::START,     S::ADVERTISING},
+    {S::BOOT,         E::FAULT,     S::ERROR},
+    {S::ADVERTISING,  E::START,     S::ADVERTISING},
+    {S::ADVERTISING,  E::LINK_UP,   S::CONNECTED},
+    {S::ADVERTISING,  E::FAULT,     S::ERROR},
+    {S::CONNECTED,    E::LINK_LOST, S::DISCONNECTED},
+    {S::DISCONNECTED, E::START,     S::ADVERTISING},
+    {S::DISCONNECTED, E::LINK_UP,   S::CONNECTED},
+    {S::DISCONNECTED, E::TIMEOUT,   S::ADVERTISING},
+    {S::ERROR,        E::START,     S::ADVERTISING},
+    {S::ERROR,        E::TIMEOUT,   S::ADVERTISING},
+};
+
+S expected(const std::vector<Edge>& edges, S from, E event) {
+    for (const Edge& e : edges) {
+        if (e.from == from && e.event == event) return e.to;
+    }
+    return S::COUNT;
+}
+
+// Shortest event path from BOOT to `target` in the expected graph.
+bool pathTo(const std::vector<Edge>& edges, S target, std::vector<E>& path) {
+    std::vector<std::vector<E>> paths(BLE_STATE_COUNT);
+    std::vector<bool> seen(BLE_STATE_COUNT, false);
+    std::vector<S> frontier = {S::BOOT};
+    seen[static_cast<size_t>(S::BOOT)] = true;
+    while (!frontier.empty()) {
+        std::vector<S> next;
+        for (S s : frontier) {
+            if (s == target) {
+                path = paths[static_cast<size_t>(s)];
+                return true;
+            }
+            for (const Edge& e : edges) {
+                const size_t to = static_cast<size_t>(e.to);
+                if (e.from != s || seen[to]) continue;
+                seen[to] = true;
+                paths[to] = paths[static_cast<size_t>(s)];
+                paths[to].push_back(e.event);
+                next.push_back(e.to);
+            }
+        }
+        frontier = next;
+    }
+    return false;
+}
+
+// Drives a fresh machine along `path`, TIMEOUT through poll().
+void walk(BleStateMachine& sm, const std::vector<E>& path, uint32_t& now) {
+    for (E e : path) {
+        if (e == E::TIMEOUT) {
+            now += sm.msUntilTimeout(now);
+            CHECK(sm.poll(now));
+        } else {
+            CHECK(sm.dispatch(e, now));
+        }
+        now += 10;
+    }
+}
+
+// Every (state, event) pair of every reachable state, on the real machine.
+void checkGraph(const BleRoleTable& table, const std::vector<Edge>& edges) {
+    for (size_t s = 0; s < BLE_STATE_COUNT; ++s) {
+        const S state = static_cast<S>(s);
+        std::vector<E> path;
+        if (!pathTo(edges, state, path)) {
+            // Unreachable in this role: no way out either
+            for (size_t e = 0; e < BLE_EVENT_COUNT; ++e) CHECK(table.next[s][e] == S::COUNT);
+            continue;
+        }
+
+        for (size_t e = 0; e < BLE_EVENT_COUNT; ++e) {
+            const E event = static_cast<E>(e);
+            const S want = expected(edges, state, event);
+            CHECK(table.next[s][e] == want);
+
+            BleStateMachine sm(table);
+            uint32_t now = 1000;
+            sm.begin(now);
+            walk(sm, path, now);
+            CHECK(sm.state() == state);
+
+            const uint32_t rejectedBefore = sm.rejectedCount();
+            bool ok;
+            if (event == E::TIMEOUT) {
+                ok = sm.poll(now + 3600000);
+            } else {
+                ok = sm.dispatch(event, now);
+            }
+            CHECK_EQ(ok, want != S::COUNT);
+            CHECK(sm.state() == (ok ? want : state));
+            if (event != E::TIMEOUT) {
+                CHECK_EQ(sm.rejectedCount(), rejectedBefore + (ok ? 0 : 1));
+            }
+        }
+    }
+}
+
+void testClientGraph() { checkGraph(BleRole::CLIENT, CLIENT_EDGES); }
+void testServerGraph() { checkGraph(BleRole::SERVER, SERVER_EDGES); }
+
+// Each timeout fires exactly at its budget, not one ms earlier.
+void testTimeoutPaths() {
+    struct Case {
+        const BleRoleTable* table;
+        const std::vector<Edge>* edges;
+        S state;
+        uint32_t timeoutMs;
+        S to;
+    };
+    const Case cases[] = {
+        {&BleRole::CLIENT, &CLIENT_EDGES, S::CONNECTING,   10000, S::ERROR},
+        {&BleRole::CLIENT, &CLIENT_EDGES, S::DISCONNECTED, 250,   S::SCANNING},
+        {&BleRole::CLIENT, &CLIENT_EDGES, S::ERROR,        2000,  S::SCANNING},
+        {&BleRole::SERVER, &SERVER_EDGES, S::DISCONNECTED, 250,   S::ADVERTISING},
+        {&BleRole::SERVER, &SERVER_EDGES, S::ERROR,        2000,  S::ADVERTISING},
+    };
+
+    for (const Case& c : cases) {
+        std::vector<E> path;
+        CHECK(pathTo(*c.edges, c.state, path));
+        BleStateMachine sm(*c.table);
+        uint32_t now = 50;
+        sm.begin(now);
+        walk(sm, path, now);
+        CHECK_EQ(sm.timeoutMs(c.state), c.timeoutMs);
+
+        const uint32_t entered = now - 10;
+        CHECK_EQ(sm.msUntilTimeout(now), c.timeoutMs - 10);
+        CHECK(!sm.poll(entered + c.timeoutMs - 1));
+        CHECK(sm.state() == c.state);
+        CHECK(sm.poll(entered + c.timeoutMs));
+        CHECK(sm.state() == c.to);
+        CHECK_EQ(sm.edgeStats(c.state, E::TIMEOUT).count, 1);
+        CHECK_EQ(sm.edgeStats(c.state, E::TIMEOUT).maxMs, c.timeoutMs);
+    }
+
+    // States without a budget never time out
+    BleStateMachine sm(BleRole::CLIENT);
+    sm.begin(0);
+    sm.dispatch(E::START, 0);
+    CHECK_EQ(sm.msUntilTimeout(0), UINT32_MAX);
+    CHECK(!sm.poll(0xFFFFFFF0u));
+    CHECK(sm.state() == S::SCANNING);
+}
+
+// Backoff override: one visit only, ignored where there is no timeout.
+void testStateTimeoutOverride() {
+    BleStateMachine sm(BleRole::CLIENT);
+    sm.begin(0);
+    CHECK(!sm.setStateTimeout(500));   // BOOT has no timeout
+    sm.dispatch(E::START, 0);
+    sm.dispatch(E::PEER_FOUND, 0);
+    sm.dispatch(E::LINK_FAILED, 100);
+    CHECK(sm.setStateTimeout(3000));
+    CHECK(!sm.poll(100 + 2999));
+    CHECK(sm.poll(100 + 3000));
+    CHECK(sm.state() == S::SCANNING);
+
+    // Next visit back to the table budget
+    sm.dispatch(E::PEER_FOUND, 4000);
+    sm.dispatch(E::LINK_FAILED, 4000);
+    CHECK_EQ(sm.msUntilTimeout(4000), 250);
+
+    // 0 would disable the timeout: raised to 1 ms
+    CHECK(sm.setStateTimeout(0));
+    CHECK(sm.poll(4001));
+}
+
+// Transition callback order, rejects and dwell statistics.
+void testCallbackAndStats() {
+    BleStateMachine sm(BleRole::SERVER);
+    std::vector<Edge> seen;
+    sm.onTransition([&](S from, S to, E event) { seen.push_back({from, event, to}); });
+    sm.begin(0);
+
+    CHECK(!sm.dispatch(E::LINK_LOST, 5));   // BOOT: rejected, no callback
+    CHECK(seen.empty());
+    CHECK(sm.lastRejectedState() == S::BOOT);
+    CHECK(sm.lastRejectedEvent() == E::LINK_LOST);
+
+    sm.dispatch(E::START, 100);
+    sm.dispatch(E::LINK_UP, 400);
+    sm.dispatch(E::LINK_LOST, 1400);
+    sm.dispatch(E::LINK_UP, 1500);          // reconnected while still advertising
+    sm.dispatch(E::LINK_LOST, 2500);
+    sm.poll(2750);
+
+    CHECK_EQ(seen.size(), 6);
+    CHECK(seen[4].from == S::CONNECTED && seen[4].to == S::DISCONNECTED);
+    CHECK(seen[5].event == E::TIMEOUT && seen[5].to == S::ADVERTISING);
+
+    CHECK_EQ(sm.stateStats(S::CONNECTED).count, 2);
+    CHECK_EQ(sm.stateStats(S::CONNECTED).totalMs, 2000);
+    CHECK_EQ(sm.stateStats(S::CONNECTED).avgMs(), 1000);
+    CHECK_EQ(sm.edgeStats(S::DISCONNECTED, E::LINK_UP).maxMs, 100);
+    CHECK_EQ(sm.timeInStateMs(3000), 250);
+    CHECK_EQ(sm.rejectedCount(), 1);
+
+    size_t edges = 0;
+    sm.forEachTakenEdge([&](S, E, S, const BleDwellStats&) { ++edges; });
+    CHECK_EQ(edges, 5);
+
+    sm.begin(0);
+    CHECK_EQ(sm.rejectedCount(), 0);
+    CHECK_EQ(sm.stateStats(S::CONNECTED).count, 0);
+}
+
+// =========================
+// Event queue
+// =========================
+void testQueueOrderAndOverflow() {
+    BleEventQueue<4> q;
+    BleEvent e;
+    CHECK(q.empty());
+    CHECK(!q.pop(e));
+
+    CHECK(q.post(E::LINK_LOST));
+    CHECK(q.post(E::START));
+    CHECK(q.post(E::LINK_UP));
+    CHECK(q.post(E::LINK_LOST));
+    CHECK(!q.post(E::START));   // full: new event dropped
+    CHECK_EQ(q.dropped(), 1);
+
+    const E order[] = {E::LINK_LOST, E::START, E::LINK_UP, E::LINK_LOST};
+    for (E want : order) {
+        CHECK(q.pop(e));
+        CHECK(e == want);
+    }
+    CHECK(q.empty());
+
+    // Index wrap-around
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(q.post(static_cast<E>(i % 6)));
+        CHECK(q.pop(e));
+        CHECK(e == static_cast<E>(i % 6));
+    }
+}
+
+// Host task posting disconnect / reconnect cycles while the loop drains
+// and dispatches: nothing lost or reordered, the server ends CONNECTED.
+void testQueueAcrossThreads() {
+    static constexpr int CYCLES = 200000;
+    BleEventQueue<8> q;
+    BleStateMachine sm(BleRole::SERVER);
+    sm.begin(0);
+    sm.dispatch(E::START, 0);
+    sm.dispatch(E::LINK_UP, 0);
+
+    std::thread host([&] {
+        const E cycle[] = {E::LINK_LOST, E::START, E::LINK_UP};
+        for (int i = 0; i < CYCLES; ++i) {
+            for (E e : cycle) {
+                while (!q.post(e)) std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t handled = 0;
+    uint32_t now = 0;
+    while (handled < CYCLES * 3u) {
+        BleEvent e;
+        if (!q.pop(e)) {
+            std::this_thread::yield();
+            continue;
+        }
+        sm.dispatch(e, ++now);
+        ++handled;
+    }
+    host.join();
+
+    CHECK_EQ(sm.rejectedCount(), 0);
+    CHECK(sm.state() == S::CONNECTED);
+    CHECK_EQ(sm.edgeStats(S::CONNECTED, E::LINK_LOST).count, CYCLES + 0u);
+    CHECK(q.empty());
+}
+
+// Frame records (BBLC STATUS notifies): every byte arrives intact and in
+// order, none torn by the producer writing the next slot.
+void testQueueCarriesRecords() {
+    static constexpr uint32_t FRAMES = 200000;
+    struct Frame {
+        uint32_t seq = 0;
+        uint8_t data[44] = {};
+    };
+    BleEventQueue<32, Frame> q;
+
+    std::thread host([&] {
+        for (uint32_t i = 0; i < FRAMES; ++i) {
+            Frame f;
+            f.seq = i;
+            memset(f.data, static_cast<uint8_t>(i), sizeof(f.data));
+            while (!q.post(f)) std::this_thread::yield();
+        }
+    });
+
+    uint32_t next = 0;
+    uint32_t torn = 0;
+    while (next < FRAMES) {
+        Frame f;
+        if (!q.pop(f)) {
+            std::this_thread::yield();
+            continue;
+        }
+        CHECK_EQ(f.seq, next);
+        for (uint8_t b : f.data) {
+            if (b != static_cast<uint8_t>(f.seq)) ++torn;
+        }
+        next = f.seq + 1;
+    }
+    host.join();
+
+    CHECK_EQ(torn, 0);
+    CHECK(q.empty());
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testClientGraph);
+    RUN_TEST(testServerGraph);
+    RUN_TEST(testTimeoutPaths);
+    RUN_TEST(testStateTimeoutOverride);
+    RUN_TEST(testCallbackAndStats);
+    RUN_TEST(testQueueOrderAndOverflow);
+    RUN_TEST(testQueueAcrossThreads);
+    RUN_TEST(testQueueCarriesRecords);
+    return HostTest::result();
+}
@@ -0,0 +1,99 @@
+// Boot timeline: first mark wins, BOOT_REPORT codec round-trip, truncation
+// to the reply size and rejection of short frames.
+
+#include "HostTest.h"
+
+#include <cstring>
+
+#include "boot/BootTimeline.h"
+
+namespace {
+
+using M = BootMilestone;
+
+void testFirstMarkWins() {
+    BootTimeline t;
+    CHECK(!t.reached(M::BLE_READY));
+    CHECK_EQ(t.atUs(M::BLE_READY), BootTimeline::NOT_REACHED);
+
+    CHECK(t.mark(M::BLE_READY, 1200));
+    CHECK(!t.mark(M::BLE_READY, 900));   // e.g. setup() marking after ble_init
+    CHECK_EQ(t.atUs(M::BLE_READY), 1200u);
+    CHECK(!t.mark(M::COUNT, 5));          // out of range
+
+    t.reset();
+    CHECK(!t.reached(M::BLE_READY));
+}
+
+void testRoundTrip() {
+    BootTimeline t;
+    t.mark(M::SETUP_ENTRY, 312400);
+    t.mark(M::LED_READY, 313100);
+    t.mark(M::ADVERTISING, 0x89ABCDEF);   // every byte of the u32 counts
+
+    uint8_t payload[BOOT_MILESTONE_COUNT * BOOT_REPORT_ENTRY + 1];
+    const size_t len = t.encode(payload, sizeof(payload));
+    CHECK_EQ(len, 1 + 3 * BOOT_REPORT_ENTRY);
+    CHECK_EQ(payload[0], 3);
+
+    BootTimeline back;
+    back.mark(M::CONNECTED, 1);   // stale entry, cleared by decode
+    CHECK(back.decode(payload, len));
+    for (size_t i = 0; i < BOOT_MILESTONE_COUNT; ++i) {
+        const M m = static_cast<M>(i);
+        CHECK_EQ(back.atUs(m), t.atUs(m));
+    }
+
+    char line[128];
+    back.format(line, sizeof(line));
+    CHECK(strcmp(line, "SETUP_ENTRY=312.4 LED_READY=313.1 ADVERTISING=2309737.9") == 0);
+}
+
+// A reply bounded by the MTU keeps the first milestones that fit whole
+void testEncodeTruncates() {
+    BootTimeline t;
+    for (size_t i = 0; i < BOOT_MILESTONE_COUNT; ++i) {
+        t.mark(static_cast<M>(i), static_cast<uint32_t>(100 * (i + 1)));
+    }
+
+    uint8_t payload[64];
+    const size_t maxLen = 1 + 2 * BOOT_REPORT_ENTRY + 3;   // two entries and a bit
+    const size_t len = t.encode(payload, maxLen);
+    CHECK_EQ(len, 1 + 2 * BOOT_REPORT_ENTRY);
+    CHECK_EQ(payload[0], 2);
+
+    BootTimeline back;
+    CHECK(back.decode(payload, len));
+    CHECK_EQ(back.atUs(M::SETUP_ENTRY), 100u);
+    CHECK_EQ(back.atUs(M::SERIAL_READY), 200u);
+    CHECK(!back.reached(M::LED_READY));
+
+    CHECK_EQ(t.encode(payload, 0), 0u);
+    CHECK_EQ(t.encode(payload, 1), 1u);   // count only
+    CHECK_EQ(payload[0], 0);
+}
+
+void testDecodeRejectsShort() {
+    BootTimeline t;
+    t.mark(M::SETUP_ENTRY, 10);
+    t.mark(M::SETUP_DONE, 20);
+    uint8_t payload[16];
+    const size_t len = t.encode(payload, sizeof(payload));
+
+    BootTimeline back;
+    back.mark(M::CONNECTED, 7);
+    CHECK(!back.decode(payload, 0));
+    CHECK(!back.decode(payload, len - 1));   // last entry cut
+    CHECK_EQ(back.atUs(M::CONNECTED), 7u);   // untouched on failure
+    CHECK(back.decode(payload, len));
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testFirstMarkWins);
+    RUN_TEST(testRoundTrip);
+    RUN_TEST(testEncodeTruncates);
+    RUN_TEST(testDecodeRejectsShort);
+    return HostTest::result();
+}
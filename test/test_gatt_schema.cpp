@@ -0,0 +1,98 @@
+// BBLH GATT schema: UUID parsing and uniqueness, the properties each side
+// relies on, and the frame sizes that must fit the characteristics.
+
+#include "HostTest.h"
+
+#include <cstring>
+
+#include "ble/BblhGattSchema.h"
+#include "ble/BleBenchmark.h"
+#include "ble/BleProtocol.h"
+#include "boot/BootTimeline.h"
+#include "storage/LaunchLog.h"
+
+namespace {
+
+using namespace BblhGatt;
+
+constexpr bool has(CharId id, uint8_t props) {
+    return (charDef(id).props & props) == props;
+}
+
+// BBLC writes CMD with and without response (FIRE, bench flood)
+static_assert(has(CharId::CMD, Prop::WRITE | Prop::WRITE_NR), "CMD must take both write types");
+static_assert(!has(CharId::CMD, Prop::NOTIFY), "CMD is client -> server only");
+// BBLC subscribes to STATUS and LOG, BBLH notifies on them
+static_assert(has(CharId::STATUS, Prop::NOTIFY), "STATUS must notify");
+static_assert(has(CharId::LOG, Prop::NOTIFY), "LOG must notify");
+static_assert(charDef(CharId::CMD).required && charDef(CharId::STATUS).required,
+              "CMD and STATUS are required by the client");
+static_assert(!charDef(CharId::LOG).required, "LOG is optional on older heads");
+
+// Control frames fit one write at the default MTU
+static_assert(BleProto::FIRE_GESTURE_FRAME_LEN <= DEFAULT_MTU_PAYLOAD, "FIRE frame too long");
+static_assert(1 + BleBench::CONFIG_SIZE <= DEFAULT_MTU_PAYLOAD, "BENCH_START frame too long");
+// Queued replies fit a scheduler slot
+static_assert(1 + BleBench::REPORT_SIZE <= STATUS_FRAME_MAX, "BENCH_REPORT frame too long");
+static_assert(BOOT_REPORT_HEADER + BOOT_MILESTONE_COUNT * BOOT_REPORT_ENTRY <= STATUS_FRAME_MAX,
+              "BOOT_REPORT frame too long");
+
+void testUuidParsing() {
+    // Little-endian, as ble_uuid128_t
+    const Uuid128 u = uuid128("00112233-4455-6677-8899-aabbccddeeff");
+    for (int i = 0; i < 16; ++i) {
+        CHECK_EQ(u.bytes[i], 0xFF - i * 0x11);
+    }
+    CHECK(uuid128("A1B2C3D4-0001-4000-8000-000000000001") == SERVICE_UUID);
+}
+
+void testUuidsUnique() {
+    for (size_t i = 0; i < CHAR_COUNT; ++i) {
+        CHECK(!(CHARACTERISTICS[i].uuid == SERVICE_UUID));
+        for (size_t j = i + 1; j < CHAR_COUNT; ++j) {
+            CHECK(memcmp(CHARACTERISTICS[i].uuid.bytes, CHARACTERISTICS[j].uuid.bytes, 16) != 0);
+        }
+    }
+}
+
+// The client binds by UUID bytes (bindClient); every characteristic the
+// server builds lands on its own slot.
+void testClientBindsServerTable() {
+    for (size_t i = 0; i < CHAR_COUNT; ++i) {
+        size_t bound = CHAR_COUNT;
+        for (size_t k = 0; k < CHAR_COUNT; ++k) {
+            if (memcmp(CHARACTERISTICS[i].uuid.bytes, CHARACTERISTICS[k].uuid.bytes, 16) == 0) {
+                bound = k;
+                break;
+            }
+        }
+        CHECK_EQ(bound, i);
+        CHECK_EQ(static_cast<size_t>(charDef(static_cast<CharId>(i)).id), i);
+    }
+}
+
+void testFrameLimits() {
+    // Every reached milestone still encodes inside a scheduler slot
+    BootTimeline t;
+    for (size_t i = 0; i < BOOT_MILESTONE_COUNT; ++i) {
+        t.mark(static_cast<BootMilestone>(i), static_cast<uint32_t>(1000 + i));
+    }
+    uint8_t frame[STATUS_FRAME_MAX + 16];
+    const size_t len = 1 + t.encode(frame + 1, sizeof(frame) - 1);
+    CHECK(len <= STATUS_FRAME_MAX);
+    CHECK_EQ(frame[1], BOOT_MILESTONE_COUNT);
+
+    // A LOG batch carries at least one record in the largest attribute
+    CHECK(BleProto::LOG_BATCH_HEADER + LAUNCH_RECORD_SIZE <= ATTR_MAX_LEN);
+    CHECK((ATTR_MAX_LEN - BleProto::LOG_BATCH_HEADER) / LAUNCH_RECORD_SIZE <= 255);   // count is u8
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testUuidParsing);
+    RUN_TEST(testUuidsUnique);
+    RUN_TEST(testClientBindsServerTable);
+    RUN_TEST(testFrameLimits);
+    return HostTest::result();
+}
@@ -0,0 +1,289 @@
+// Nearest head selection: window rules, eligibility, and a synthetic
+// hall compared with the previous "first head heard" rule.
+
+#include "HostTest.h"
+
+#include "ble/HeadSelector.h"
+
+namespace {
+
+using Selector = HeadSelector<uint8_t, 4>;
+
+AdvStatus statusWith(uint8_t flags) {
+    AdvStatus s;
+    s.flags = flags;
+    return s;
+}
+
+const AdvStatus FREE = statusWith(AdvStatusFlag::SLOT_FREE);
+const AdvStatus FREE_READY = statusWith(AdvStatusFlag::SLOT_FREE | AdvStatusFlag::READY);
+
+void hear(Selector& s, uint8_t head, int8_t rssi, int times, const AdvStatus* status = &FREE) {
+    for (int i = 0; i < times; ++i) s.observe(head, rssi, status);
+}
+
+void testNothingPickedWhileCollecting() {
+    Selector s;
+    s.begin(0);
+    CHECK(s.picked() == nullptr);
+    CHECK(s.poll(0) == HeadSelectResult::COLLECTING);
+    CHECK(s.picked() == nullptr);
+
+    hear(s, 1, -70, 5);
+    CHECK(s.poll(100) == HeadSelectResult::COLLECTING);   // before minWindowMs
+    CHECK(s.picked() == nullptr);
+    CHECK_EQ(s.msUntilDecision(100), 1400);
+}
+
+// In hand: picked as soon as it has minSamples, without waiting for the window.
+void testNearPicksEarly() {
+    Selector s;
+    s.begin(1000);
+    hear(s, 7, -30, 2);
+    CHECK(s.poll(1010) == HeadSelectResult::COLLECTING);   // one lucky packet is not enough
+    hear(s, 7, -30, 1);
+    CHECK(s.poll(1020) == HeadSelectResult::PICKED);
+    const Selector::Candidate* head = s.picked();
+    CHECK(head != nullptr);
+    if (head) {
+        CHECK_EQ(head->address, 7);
+        CHECK_EQ(head->rssiDbm(), -30);
+    }
+    CHECK(s.pickedEarly());
+    CHECK_EQ(s.selectionMs(), 20);
+    CHECK_EQ(s.msUntilDecision(1020), 0);
+
+    // Sticky until the next begin()
+    hear(s, 8, -20, 5);
+    CHECK(s.poll(1030) == HeadSelectResult::PICKED);
+    CHECK_EQ(s.picked()->address, 7);
+    s.begin(2000);
+    CHECK(s.picked() == nullptr);
+}
+
+void testClearMarginAfterMinWindow() {
+    Selector s;
+    s.begin(0);
+    hear(s, 1, -60, 4);
+    hear(s, 2, -75, 4);
+    CHECK(s.poll(299) == HeadSelectResult::COLLECTING);
+    CHECK(s.poll(300) == HeadSelectResult::PICKED);
+    CHECK_EQ(s.picked()->address, 1);
+    CHECK(s.pickedEarly());
+
+    // Close call: wait for the window end, then take the leader
+    s.begin(0);
+    hear(s, 1, -60, 4);
+    hear(s, 2, -64, 4);
+    CHECK(s.poll(1499) == HeadSelectResult::COLLECTING);
+    CHECK(s.poll(1500) == HeadSelectResult::PICKED);
+    CHECK_EQ(s.picked()->address, 1);
+    CHECK(!s.pickedEarly());
+}
+
+// READY breaks a tie, the latest advertised state wins.
+void testReadyBonusAndLatestState() {
+    Selector s;
+    s.begin(0);
+    hear(s, 1, -60, 4);
+    hear(s, 2, -61, 4, &FREE_READY);
+    CHECK(s.poll(1500) == HeadSelectResult::PICKED);
+    CHECK_EQ(s.picked()->address, 2);
+
+    const AdvStatus taken = statusWith(AdvStatusFlag::READY | AdvStatusFlag::HAS_CONTROLLER);
+    s.begin(0);
+    hear(s, 1, -60, 4);
+    hear(s, 2, -50, 4);
+    hear(s, 2, -50, 1, &taken);   // another controller got there first
+    CHECK(s.poll(1500) == HeadSelectResult::PICKED);
+    CHECK_EQ(s.picked()->address, 1);
+}
+
+void testIneligibleGivesEmpty() {
+    const AdvStatus fault = statusWith(AdvStatusFlag::SLOT_FREE | AdvStatusFlag::FAULT);
+    const AdvStatus full = statusWith(AdvStatusFlag::READY);
+    Selector s;
+    s.begin(0);
+    hear(s, 1, -40, 5, &fault);
+    hear(s, 2, -40, 5, &full);
+    hear(s, 3, -95, 5);   // below floorDbm
+    CHECK(s.poll(300) == HeadSelectResult::COLLECTING);
+    CHECK(s.poll(1500) == HeadSelectResult::EMPTY);
+    CHECK(s.picked() == nullptr);
+    CHECK_EQ(s.candidates(), 2u);
+
+    // A head without status is assumed to accept us
+    s.begin(0);
+    hear(s, 4, -40, 3, nullptr);
+    CHECK(s.poll(10) == HeadSelectResult::PICKED);
+    CHECK_EQ(s.picked()->address, 4);
+}
+
+// Crowded hall: a stronger newcomer evicts the weakest head, a weaker
+// one is ignored, ineligible heads go first.
+void testCapacity() {
+    Selector s;
+    s.begin(0);
+    for (uint8_t h = 0; h < 6; ++h) hear(s, h, static_cast<int8_t>(-80 + h * 5), 4);
+    CHECK_EQ(s.candidates(), 4u);
+    hear(s, 9, -85, 4);   // weaker than every tracked head
+    CHECK(s.poll(1500) == HeadSelectResult::PICKED);
+    CHECK_EQ(s.picked()->address, 5);
+    hear(s, 8, -20, 4);   // table frozen once picked
+    CHECK_EQ(s.picked()->address, 5);
+
+    const AdvStatus taken = statusWith(AdvStatusFlag::READY | AdvStatusFlag::HAS_CONTROLLER);
+    s.begin(0);
+    hear(s, 0, -40, 4, &taken);
+    for (uint8_t h = 1; h < 4; ++h) hear(s, h, -60, 4);
+    hear(s, 7, -88, 4);   // weakest of all, still takes the ineligible slot
+    CHECK_EQ(s.candidates(), 4u);
+    CHECK(s.poll(1500) == HeadSelectResult::PICKED);
+    CHECK(s.picked()->address != 0);
+}
+
+// Filtered RSSI rounds to nearest: no upward bias on negative values
+void testRssiRounding() {
+    Selector s;
+    s.begin(0);
+    hear(s, 1, -70, 1);
+    hear(s, 1, -71, 20);
+    CHECK(s.poll(1500) == HeadSelectResult::PICKED);
+    CHECK_EQ(s.picked()->rssiDbm(), -71);
+}
+
+// =========================
+// Synthetic hall
+// =========================
+// `heads` BBLH advertise every 30-60 ms, each heard with a 1/3 chance
+// (scan window 15 / interval 45 ms). Mean RSSI per head is drawn in
+// [-85, -40] dBm, each packet gets +-6 dB of noise and a 10 % chance of
+// a 15 dB fade. One head in five already has a controller. A pick is
+// correct when it is the eligible head with the highest mean.
+struct HallResult {
+    uint32_t trials = 0;
+    uint32_t correct = 0;
+    uint32_t early = 0;
+    uint32_t totalMs = 0;
+    uint32_t maxMs = 0;
+    uint32_t regretDb = 0;          // sum of (best mean - picked mean)
+    uint32_t takenPicks = 0;        // head that already has a controller
+    uint32_t firstHeardCorrect = 0;
+    uint32_t firstHeardMs = 0;
+    uint32_t firstHeardRegretDb = 0;
+};
+
+HallResult runHall(uint32_t trials, uint8_t heads, uint32_t seed) {
+    static constexpr uint8_t MAX_HEADS = 16;
+    HostTest::Rng rng(seed);
+    HallResult r;
+    HeadSelector<uint8_t, MAX_HEADS> selector;
+    const HeadSelectConfig config;
+
+    for (uint32_t t = 0; t < trials; ++t) {
+        int8_t mean[MAX_HEADS];
+        bool taken[MAX_HEADS];
+        uint32_t nextAdv[MAX_HEADS];
+        int bestHead = -1;
+
+        for (uint8_t h = 0; h < heads; ++h) {
+            mean[h] = static_cast<int8_t>(rng.range(-85, -40));
+            taken[h] = rng.oneIn(5);
+            nextAdv[h] = static_cast<uint32_t>(rng.range(0, 59));
+            if (!taken[h] && (bestHead < 0 || mean[h] > mean[bestHead])) bestHead = h;
+        }
+        if (bestHead < 0) continue;   // every head taken, nothing to find
+        ++r.trials;
+
+        selector.begin(0);
+        int firstHeard = -1;
+        uint32_t firstHeardMs = 0;
+
+        for (uint32_t now = 0;; ++now) {
+            for (uint8_t h = 0; h < heads; ++h) {
+                if (now < nextAdv[h]) continue;
+                nextAdv[h] = now + static_cast<uint32_t>(rng.range(30, 60));
+                if (!rng.oneIn(3)) continue;   // outside the scan window
+
+                int rssi = mean[h] + rng.range(-6, 6);
+                if (rng.oneIn(10)) rssi -= 15;
+
+                AdvStatus status;
+                status.flags = AdvStatusFlag::READY;
+                status.flags |= taken[h] ? AdvStatusFlag::HAS_CONTROLLER : AdvStatusFlag::SLOT_FREE;
+                selector.observe(h, static_cast<int8_t>(rssi), &status);
+
+                if (firstHeard < 0 && rssi >= config.floorDbm) {
+                    firstHeard = h;
+                    firstHeardMs = now;
+                }
+            }
+
+            const HeadSelectResult res = selector.poll(now);
+            if (res == HeadSelectResult::COLLECTING) continue;
+            if (res == HeadSelectResult::EMPTY) {
+                selector.begin(now);
+                continue;
+            }
+
+            const uint8_t picked = selector.picked()->address;
+            const uint32_t ms = selector.selectionMs();
+            if (taken[picked]) ++r.takenPicks;
+            if (mean[picked] == mean[bestHead]) ++r.correct;
+            if (selector.pickedEarly()) ++r.early;
+            r.totalMs += ms;
+            if (ms > r.maxMs) r.maxMs = ms;
+            r.regretDb += static_cast<uint32_t>(mean[bestHead] - mean[picked]);
+            break;
+        }
+
+        // Old rule: first BBLH heard, whatever its state
+        if (firstHeard >= 0) {
+            if (mean[firstHeard] == mean[bestHead]) ++r.firstHeardCorrect;
+            r.firstHeardMs += firstHeardMs;
+            r.firstHeardRegretDb += static_cast<uint32_t>(
+                mean[bestHead] > mean[firstHeard] ? mean[bestHead] - mean[firstHeard] : 0);
+        }
+    }
+    return r;
+}
+
+void testSyntheticHall() {
+    const uint8_t halls[] = {1, 4, 12};
+    for (uint8_t heads : halls) {
+        const HallResult r = runHall(2000, heads, heads);
+        printf("BENCH head select %u heads: %lu trials, correct %.1f %% (first heard %.1f %%), regret %.2f dB (first heard %.2f dB), %.1f %% early, avg %lu ms max %lu ms (first heard avg %lu ms)\n",
+               static_cast<unsigned>(heads), (unsigned long)r.trials,
+               100.0 * r.correct / r.trials, 100.0 * r.firstHeardCorrect / r.trials,
+               static_cast<double>(r.regretDb) / r.trials, static_cast<double>(r.firstHeardRegretDb) / r.trials,
+               100.0 * r.early / r.trials,
+               (unsigned long)(r.totalMs / r.trials), (unsigned long)r.maxMs,
+               (unsigned long)(r.firstHeardMs / r.trials));
+
+        CHECK(r.trials > 1000);
+        // Never a head that already has a controller, never past the window
+        CHECK_EQ(r.takenPicks, 0);
+        CHECK(r.maxMs <= HeadSelectConfig().windowMs);
+        if (heads == 1) {
+            CHECK_EQ(r.correct, r.trials);
+        } else {
+            CHECK(r.correct > r.firstHeardCorrect);
+            CHECK(r.regretDb < r.trials);   // under 1 dB from the best head on average
+            CHECK(r.regretDb * 2 < r.firstHeardRegretDb);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testNothingPickedWhileCollecting);
+    RUN_TEST(testNearPicksEarly);
+    RUN_TEST(testClearMarginAfterMinWindow);
+    RUN_TEST(testReadyBonusAndLatestState);
+    RUN_TEST(testIneligibleGivesEmpty);
+    RUN_TEST(testCapacity);
+    RUN_TEST(testRssiRounding);
+    RUN_TEST(testSyntheticHall);
+    return HostTest::result();
+}
@@ -0,0 +1,314 @@
+// Launch log on a file-backed NOR flash simulator: recovery, wrap-around,
+// crash and write-failure injection, and the append / recovery / export
+// benchmark.
+
+#include "HostTest.h"
+
+#include <vector>
+
+#include "storage/LaunchLog.h"
+
+namespace {
+
+// NOR semantics: erase sets 0xFF, a write can only clear bits. Backed by
+// a temporary file so a "reboot" is a new LaunchLog on the same file.
+class FileFlash {
+public:
+    FileFlash(size_t size, size_t sectorSize) : size_(size), sectorSize_(sectorSize) {
+        file_ = tmpfile();
+        std::vector<uint8_t> erased(size_, 0xFF);
+        fwrite(erased.data(), 1, size_, file_);
+    }
+    ~FileFlash() { if (file_) fclose(file_); }
+
+    size_t size() const { return size_; }
+    size_t sectorSize() const { return sectorSize_; }
+
+    bool read(uint32_t addr, void* dst, size_t len) {
+        if (addr + len > size_) return false;
+        ++reads;
+        readBytes += len;
+        fseek(file_, static_cast<long>(addr), SEEK_SET);
+        return fread(dst, 1, len, file_) == len;
+    }
+
+    bool write(uint32_t addr, const void* src, size_t len) {
+        if (addr + len > size_) return false;
+        ++writes;
+        if (failWrites > 0) {
+            --failWrites;
+            return false;   // nothing programmed
+        }
+        size_t programmed = len;
+        bool ok = true;
+        if (tearNextWrite) {
+            tearNextWrite = false;
+            programmed = len / 2;   // power lost mid-write
+            ok = false;
+        }
+        std::vector<uint8_t> cur(programmed);
+        fseek(file_, static_cast<long>(addr), SEEK_SET);
+        if (fread(cur.data(), 1, programmed, file_) != programmed) return false;
+        const uint8_t* p = static_cast<const uint8_t*>(src);
+        for (size_t i = 0; i < programmed; ++i) cur[i] &= p[i];
+        fseek(file_, static_cast<long>(addr), SEEK_SET);
+        fwrite(cur.data(), 1, programmed, file_);
+        return ok;
+    }
+
+    bool eraseSector(uint32_t index) {
+        if ((index + 1) * sectorSize_ > size_) return false;
+        ++erases;
+        std::vector<uint8_t> erased(sectorSize_, 0xFF);
+        fseek(file_, static_cast<long>(index * sectorSize_), SEEK_SET);
+        return fwrite(erased.data(), 1, sectorSize_, file_) == sectorSize_;
+    }
+
+    void resetCounters() { reads = writes = erases = 0; readBytes = 0; }
+
+    // Typical SPI NOR timings (ESP32-C3 internal flash, 40 MHz QIO)
+    uint32_t modelledUs() const {
+        return static_cast<uint32_t>(reads * 10 + readBytes / 16 + writes * 400 + erases * 45000);
+    }
+
+    uint32_t reads = 0;
+    uint32_t writes = 0;
+    uint32_t erases = 0;
+    uint64_t readBytes = 0;
+    uint32_t failWrites = 0;
+    bool tearNextWrite = false;
+
+private:
+    FILE* file_ = nullptr;
+    size_t size_;
+    size_t sectorSize_;
+};
+
+// Same geometry as the BBLH "launchlog" partition
+static constexpr size_t PART_SIZE = 0x40000;
+static constexpr size_t SECTOR = 4096;
+
+using Log = LaunchLog<FileFlash>;
+
+LaunchRecord makeRecord(uint8_t profile) {
+    LaunchRecord r {};
+    r.timestampMs = 1000u * profile;
+    r.profile = profile;
+    return r;
+}
+
+std::vector<LaunchRecord> readAll(Log& log) {
+    std::vector<LaunchRecord> out;
+    LaunchRecord batch[10];
+    Log::Cursor c = log.oldest();
+    while (!log.exhausted(c)) {
+        const size_t n = log.readBatch(c, batch, 10);
+        out.insert(out.end(), batch, batch + n);
+    }
+    return out;
+}
+
+bool strictlyIncreasing(const std::vector<LaunchRecord>& v) {
+    for (size_t i = 1; i < v.size(); ++i) {
+        if (v[i].seq <= v[i - 1].seq) return false;
+    }
+    return true;
+}
+
+void testFormatAndReopen() {
+    FileFlash flash(PART_SIZE, SECTOR);
+    {
+        Log log(flash);
+        CHECK(log.begin());
+        CHECK_EQ(log.nextSeq(), 0);
+        CHECK_EQ(log.capacity(), 63u * 169u);
+        for (int i = 0; i < 500; ++i) {
+            LaunchRecord r = makeRecord(static_cast<uint8_t>(i));
+            CHECK(log.append(r));
+            log.maintain();
+        }
+    }
+    Log log(flash);
+    CHECK(log.begin());
+    CHECK_EQ(log.nextSeq(), 500);
+    CHECK_EQ(log.bootCount(), 1);
+    const std::vector<LaunchRecord> all = readAll(log);
+    CHECK_EQ(all.size(), 500);
+    CHECK(strictlyIncreasing(all));
+    CHECK_EQ(all.back().profile, static_cast<uint8_t>(499));
+}
+
+void testWrapAround() {
+    FileFlash flash(PART_SIZE, SECTOR);
+    Log log(flash);
+    CHECK(log.begin());
+    const uint32_t total = static_cast<uint32_t>(log.capacity() * 3 + 77);
+    for (uint32_t i = 0; i < total; ++i) {
+        LaunchRecord r = makeRecord(static_cast<uint8_t>(i));
+        CHECK(log.append(r));
+        log.maintain();
+    }
+
+    Log again(flash);
+    CHECK(again.begin());
+    CHECK_EQ(again.nextSeq(), total);
+    const std::vector<LaunchRecord> all = readAll(again);
+    CHECK(all.size() >= again.capacity() - 169u);
+    CHECK(all.size() <= again.capacity() + 169u);   // + the partial head sector
+    CHECK(strictlyIncreasing(all));
+    CHECK_EQ(all.back().seq, total - 1);
+}
+
+// Appends in steady state never wait for an erase: maintain() did it.
+void testAppendNeverErases() {
+    FileFlash flash(PART_SIZE, SECTOR);
+    Log log(flash);
+    CHECK(log.begin());
+    uint32_t appendErases = 0;
+    for (int i = 0; i < 5000; ++i) {
+        const uint32_t before = flash.erases;
+        LaunchRecord r = makeRecord(1);
+        log.append(r);
+        appendErases += flash.erases - before;
+        log.maintain();
+    }
+    CHECK_EQ(appendErases, 0);
+}
+
+// Power lost in the middle of a record: the torn record is dropped and
+// writing resumes after it.
+void testTornRecord() {
+    FileFlash flash(PART_SIZE, SECTOR);
+    {
+        Log log(flash);
+        CHECK(log.begin());
+        for (int i = 0; i < 40; ++i) {
+            LaunchRecord r = makeRecord(1);
+            log.append(r);
+        }
+        flash.tearNextWrite = true;
+        flash.failWrites = 1;   // the zero fill never happens either
+        LaunchRecord r = makeRecord(2);
+        CHECK(!log.append(r));
+    }
+    Log log(flash);
+    CHECK(log.begin());
+    CHECK_EQ(log.nextSeq(), 40);
+    LaunchRecord r = makeRecord(3);
+    CHECK(log.append(r));
+    const std::vector<LaunchRecord> all = readAll(log);
+    CHECK_EQ(all.size(), 41);
+    CHECK(strictlyIncreasing(all));
+}
+
+// A failed append that programmed nothing leaves an erased slot behind
+// the records written after it. Recovery must not resume in that gap.
+void testFailedAppendGap() {
+    for (int gapAt : {0, 3, 84, 150}) {
+        FileFlash flash(PART_SIZE, SECTOR);
+        {
+            Log log(flash);
+            CHECK(log.begin());
+            for (int i = 0; i < 160; ++i) {
+                if (i == gapAt) {
+                    flash.failWrites = 2;   // record and its zero fill
+                    LaunchRecord r = makeRecord(0xEE);
+                    CHECK(!log.append(r));
+                }
+                LaunchRecord r = makeRecord(static_cast<uint8_t>(i));
+                CHECK(log.append(r));
+            }
+        }
+
+        Log log(flash);
+        CHECK(log.begin());
+        CHECK_EQ(log.nextSeq(), 160);
+        for (int i = 0; i < 20; ++i) {
+            LaunchRecord r = makeRecord(0x55);
+            CHECK(log.append(r));
+        }
+
+        const std::vector<LaunchRecord> all = readAll(log);
+        CHECK_EQ(all.size(), 180);
+        CHECK(strictlyIncreasing(all));
+        CHECK_EQ(all[159].profile, 159);   // nothing overwritten
+    }
+}
+
+// A failed append whose zero fill succeeded is found by the binary search.
+void testFailedAppendMarked() {
+    FileFlash flash(PART_SIZE, SECTOR);
+    {
+        Log log(flash);
+        CHECK(log.begin());
+        for (int i = 0; i < 10; ++i) {
+            LaunchRecord r = makeRecord(1);
+            log.append(r);
+        }
+        flash.failWrites = 1;
+        LaunchRecord r = makeRecord(2);
+        CHECK(!log.append(r));
+        for (int i = 0; i < 10; ++i) {
+            LaunchRecord q = makeRecord(3);
+            log.append(q);
+        }
+    }
+    Log log(flash);
+    CHECK(log.begin());
+    CHECK_EQ(log.nextSeq(), 20);
+    CHECK_EQ(readAll(log).size(), 20);
+}
+
+// Append cost, recovery on a full partition and export throughput.
+void benchLaunchLog() {
+    FileFlash flash(PART_SIZE, SECTOR);
+    Log log(flash);
+    CHECK(log.begin());
+
+    const uint32_t n = static_cast<uint32_t>(log.capacity() * 2);
+    flash.resetCounters();
+    const uint64_t t0 = HostTest::nowUs();
+    for (uint32_t i = 0; i < n; ++i) {
+        LaunchRecord r = makeRecord(static_cast<uint8_t>(i));
+        log.append(r);
+        log.maintain();
+    }
+    const uint64_t appendUs = HostTest::nowUs() - t0;
+    printf("BENCH launch log append: %.2f us/record host, flash %.2f writes/record, %lu erases for %lu records\n",
+           static_cast<double>(appendUs) / n, static_cast<double>(flash.writes) / n,
+           (unsigned long)flash.erases, (unsigned long)n);
+
+    flash.resetCounters();
+    Log recovered(flash);
+    const uint64_t t1 = HostTest::nowUs();
+    CHECK(recovered.begin());
+    const uint64_t recoverUs = HostTest::nowUs() - t1;
+    CHECK_EQ(recovered.nextSeq(), n);
+    printf("BENCH launch log recovery (full partition): %lu reads, %lu bytes, ~%lu us on flash, %lu us host\n",
+           (unsigned long)flash.reads, (unsigned long)flash.readBytes,
+           (unsigned long)flash.modelledUs(), (unsigned long)recoverUs);
+    CHECK(flash.reads < 200);
+
+    // Export in MTU 247 batches: (247 - 3 - 2) / 24 = 10 records per notify
+    flash.resetCounters();
+    const uint64_t t2 = HostTest::nowUs();
+    const std::vector<LaunchRecord> all = readAll(recovered);
+    const uint64_t exportUs = HostTest::nowUs() - t2;
+    CHECK(strictlyIncreasing(all));
+    printf("BENCH launch log export: %zu records in %lu flash reads, ~%lu us on flash, %lu us host\n",
+           all.size(), (unsigned long)flash.reads, (unsigned long)flash.modelledUs(),
+           (unsigned long)exportUs);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testFormatAndReopen);
+    RUN_TEST(testWrapAround);
+    RUN_TEST(testAppendNeverErases);
+    RUN_TEST(testTornRecord);
+    RUN_TEST(testFailedAppendGap);
+    RUN_TEST(testFailedAppendMarked);
+    RUN_TEST(benchLaunchLog);
+    return HostTest::result();
+}
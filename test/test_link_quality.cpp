@@ -0,0 +1,194 @@
+// Link quality monitor + TX power policy on synthetic RSSI traces.
+
+#include "HostTest.h"
+
+#include "ble/LinkQuality.h"
+
+namespace {
+
+// The filter settles on the exact dBm for steady negative and positive input.
+void testEwmaConvergesBothWays() {
+    for (int target = -100; target <= 10; ++target) {
+        LinkQualityMonitor up;
+        up.addRssi(-110);
+        LinkQualityMonitor down;
+        down.addRssi(20);
+        for (int i = 0; i < 60; ++i) {
+            up.addRssi(static_cast<int8_t>(target));
+            down.addRssi(static_cast<int8_t>(target));
+        }
+        CHECK_EQ(up.snapshot().rssiDbm, target);
+        CHECK_EQ(down.snapshot().rssiDbm, target);
+    }
+}
+
+// Zero-mean noise must not pull the estimate: truncation toward zero used to
+// bias negative RSSI upwards by up to one dBm.
+void testEwmaUnbiasedUnderNoise() {
+    HostTest::Rng rng(0xC0FFEE);
+    for (int target = -90; target <= -40; target += 10) {
+        LinkQualityMonitor m;
+        long sum = 0;
+        int n = 0;
+        for (int i = 0; i < 4000; ++i) {
+            m.addRssi(static_cast<int8_t>(target + rng.range(-4, 4)));
+            if (i >= 100) {
+                sum += m.snapshot().rssiDbm;
+                ++n;
+            }
+        }
+        const long meanX10 = (sum * 10) / n;
+        CHECK(meanX10 >= target * 10 - 3 && meanX10 <= target * 10 + 3);
+    }
+}
+
+void testErrorRateWindow() {
+    LinkQualityMonitor m;
+    for (int i = 0; i < 20; ++i) m.addTxResult(i % 10 != 0);
+    m.addRetry();
+    LinkQualitySnapshot s = m.snapshot();
+    CHECK_EQ(s.txCount, 20);
+    CHECK_EQ(s.errorPermille, 100);
+    CHECK_EQ(s.retries, 1);
+    CHECK(!s.hasRssi);
+
+    m.addRssi(-60);
+    m.startWindow();
+    s = m.snapshot();
+    CHECK_EQ(s.txCount, 0);
+    CHECK_EQ(s.errorPermille, 0);
+    CHECK(s.hasRssi);
+    CHECK_EQ(s.rssiDbm, -60);
+}
+
+LinkQualitySnapshot rssiOnly(LinkQualityMonitor& m, int8_t rssi) {
+    m.addRssi(rssi);
+    return m.snapshot();
+}
+
+// Close range: steps down one level per hold period to the lowest level.
+void testStepsDownGraduallyAtShortRange() {
+    TxPowerPolicy policy;
+    TxPowerController tx(policy);
+    LinkQualityMonitor m;
+    int changes = 0;
+    int samples = 0;
+    while (tx.level() > 0 && samples < 200) {
+        changes += tx.update(rssiOnly(m, -40), 9) ? 1 : 0;
+        ++samples;
+    }
+    CHECK_EQ(tx.level(), 0);
+    CHECK_EQ(changes, TX_POWER_LEVEL_MAX);
+    CHECK_EQ(samples, TX_POWER_LEVEL_MAX * policy.downHoldSamples);
+}
+
+// The level reached keeps the target margin at the peer.
+void testKeepsTargetMargin() {
+    TxPowerPolicy policy;
+    for (int pathLoss = 40; pathLoss <= 110; pathLoss += 5) {
+        TxPowerController tx(policy);
+        LinkQualityMonitor m;
+        for (int i = 0; i < 100; ++i) {
+            // Peer at 0 dBm, so the RSSI is minus the path loss.
+            tx.update(rssiOnly(m, static_cast<int8_t>(-pathLoss)), 0);
+        }
+        const int margin = tx.dbm() - pathLoss - policy.sensitivityDbm;
+        if (tx.level() < TX_POWER_LEVEL_MAX) {
+            CHECK(margin >= policy.targetMarginDb);
+        }
+        if (tx.level() > 0) {
+            // One level lower would not clear margin + hysteresis.
+            const int lower = TX_POWER_LEVELS[tx.level() - 1].dbm - pathLoss - policy.sensitivityDbm;
+            CHECK(lower < policy.targetMarginDb + policy.hysteresisDb);
+        }
+    }
+}
+
+// A sudden fade jumps up in a single update.
+void testJumpsUpOnFade() {
+    TxPowerController tx;
+    LinkQualityMonitor m;
+    for (int i = 0; i < 100; ++i) tx.update(rssiOnly(m, -45), 0);
+    CHECK_EQ(tx.level(), 0);
+
+    // Body blocking: 25 dB more path loss. The EWMA needs a few samples to
+    // follow, but once the margin breaks the level is set in one update.
+    int raises = 0;
+    for (int i = 0; i < 40; ++i) {
+        const uint8_t before = tx.level();
+        tx.update(rssiOnly(m, -70), 0);
+        if (tx.level() > before) ++raises;
+    }
+    CHECK_EQ(m.snapshot().rssiDbm, -70);
+    CHECK(tx.dbm() - 70 + 94 >= 15);
+    CHECK(raises <= 2);
+}
+
+void testErrorsForceMaxPower() {
+    TxPowerController tx;
+    LinkQualityMonitor m;
+    for (int i = 0; i < 100; ++i) tx.update(rssiOnly(m, -40), 0);
+    CHECK_EQ(tx.level(), 0);
+
+    for (int i = 0; i < 10; ++i) m.addTxResult(i < 8);
+    CHECK(tx.update(m.snapshot(), 0));
+    CHECK_EQ(tx.level(), TX_POWER_LEVEL_MAX);
+
+    // Too few operations: the error rate is not trusted.
+    TxPowerController quiet;
+    LinkQualityMonitor q;
+    for (int i = 0; i < 100; ++i) quiet.update(rssiOnly(q, -40), 0);
+    q.startWindow();
+    q.addTxResult(false);
+    q.addTxResult(false);
+    quiet.update(q.snapshot(), 0);
+    CHECK_EQ(quiet.level(), 0);
+}
+
+// RSSI hovering on a level boundary must not make the power flap.
+void testHysteresisLimitsFlapping() {
+    HostTest::Rng rng(1234);
+    TxPowerController tx;
+    LinkQualityMonitor m;
+    int changes = 0;
+    // Path loss ~88 dB: margin boundary between -12/-9 dBm and -9/-6 dBm.
+    for (int i = 0; i < 2000; ++i) {
+        const int8_t rssi = static_cast<int8_t>(-88 + rng.range(-3, 3));
+        if (tx.update(rssiOnly(m, rssi), 0) && i >= 100) ++changes;
+    }
+    CHECK(changes <= 10);
+}
+
+// Both ends adapting: each side uses the other's published level.
+void testTwoSidedConvergence() {
+    TxPowerController a;
+    TxPowerController b;
+    LinkQualityMonitor ma;
+    LinkQualityMonitor mb;
+    const int pathLoss = 60;
+    for (int i = 0; i < 200; ++i) {
+        ma.addRssi(static_cast<int8_t>(b.dbm() - pathLoss));
+        mb.addRssi(static_cast<int8_t>(a.dbm() - pathLoss));
+        a.update(ma.snapshot(), b.dbm());
+        b.update(mb.snapshot(), a.dbm());
+    }
+    CHECK_EQ(a.level(), 0);
+    CHECK_EQ(b.level(), 0);
+    printf("BENCH tx_power two-sided path_loss=%d level=%d dBm radio=%u mA (max %u mA)\n",
+           pathLoss, a.dbm(), a.currentMa(), TX_POWER_LEVELS[TX_POWER_LEVEL_MAX].currentMa);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testEwmaConvergesBothWays);
+    RUN_TEST(testEwmaUnbiasedUnderNoise);
+    RUN_TEST(testErrorRateWindow);
+    RUN_TEST(testStepsDownGraduallyAtShortRange);
+    RUN_TEST(testKeepsTargetMargin);
+    RUN_TEST(testJumpsUpOnFade);
+    RUN_TEST(testErrorsForceMaxPower);
+    RUN_TEST(testHysteresisLimitsFlapping);
+    RUN_TEST(testTwoSidedConvergence);
+    return HostTest::result();
+}
@@ -0,0 +1,215 @@
+// Peer table + multi-central notify simulation.
+
+#include "HostTest.h"
+
+#include <deque>
+#include <vector>
+
+#include "ble/PeerTable.h"
+
+namespace {
+
+struct NoExt {};
+using Table = PeerTable<3, NoExt>;
+
+void testAddRemove() {
+    Table t;
+    CHECK(t.empty());
+    CHECK(t.add(10, 0) != nullptr);
+    CHECK(t.add(10, 0) == nullptr);   // same handle twice
+    CHECK(t.add(11, 0) != nullptr);
+    CHECK(t.add(12, 0) != nullptr);
+    CHECK(t.full());
+    CHECK(t.add(13, 0) == nullptr);
+    CHECK(t.remove(11));
+    CHECK(!t.remove(11));
+    CHECK_EQ(t.count(), 2);
+    CHECK(t.add(13, 5) != nullptr);
+    CHECK_EQ(t.find(13)->connectedAtMs, 5);
+
+    uint16_t handles[3];
+    CHECK_EQ(t.handles(handles), 3);
+}
+
+void testSingleController() {
+    Table t;
+    t.add(1, 0);
+    t.add(2, 0);
+    CHECK(!t.canFire(1));
+    CHECK(t.claimRole(1, PeerRole::CONTROLLER));
+    CHECK(!t.claimRole(2, PeerRole::CONTROLLER));
+    CHECK(t.claimRole(2, PeerRole::REFEREE));
+    CHECK(t.canFire(1));
+    CHECK(!t.canFire(2));
+    CHECK(t.claimRole(1, PeerRole::CONTROLLER));   // re-claim by the holder
+    t.remove(1);
+    CHECK(!t.hasRole(PeerRole::CONTROLLER));
+    CHECK(t.claimRole(2, PeerRole::CONTROLLER));
+    CHECK(!t.claimRole(99, PeerRole::REFEREE));
+}
+
+void testSubscriberRotation() {
+    Table t;
+    for (uint16_t h = 1; h <= 3; ++h) t.add(h, 0)->subscribed = true;
+    int first[4] = {0, 0, 0, 0};
+    uint16_t out[3];
+    for (int i = 0; i < 30; ++i) {
+        CHECK_EQ(t.subscribers(out), 3);
+        ++first[out[0]];
+    }
+    CHECK_EQ(first[1], 10);
+    CHECK_EQ(first[2], 10);
+    CHECK_EQ(first[3], 10);
+
+    t.find(2)->subscribed = false;
+    CHECK_EQ(t.subscribers(out), 2);
+    CHECK(t.hasSubscriber());
+}
+
+// =========================
+// Multi-central simulation
+// =========================
+// One head, several centrals with their own connection interval. The
+// stack model is a shared pool of host buffers: notify() fails when the
+// pool is empty, and each central's link frees up to PACKETS_PER_EVENT
+// buffers at each of its connection events. The server mirrors
+// BleServerBBLH::pumpNotifications(): the latest status is fanned out to
+// the subscribers in PeerTable order, kept if nobody took it, dropped for
+// the peers that missed it otherwise.
+struct SimCentral {
+    uint32_t intervalUs;
+    uint32_t nextEventUs;
+    std::deque<uint32_t> inFlight;   // creation time of each queued packet
+    uint32_t delivered = 0;
+    uint32_t refused = 0;
+    uint64_t latencySumUs = 0;
+    uint32_t latencyMaxUs = 0;
+
+    uint32_t avgLatencyUs() const { return delivered ? static_cast<uint32_t>(latencySumUs / delivered) : 0; }
+};
+
+struct SimResult {
+    std::vector<SimCentral> centrals;
+    double fairness;   // Jain's index on delivered / offered
+};
+
+static constexpr uint32_t PACKETS_PER_EVENT = 4;
+
+SimResult runMultiCentral(const std::vector<uint32_t>& intervalsUs, uint32_t poolSize,
+                          uint32_t statusPeriodUs, uint32_t durationUs, bool rotate) {
+    Table table;
+    SimResult r;
+    for (size_t i = 0; i < intervalsUs.size(); ++i) {
+        table.add(static_cast<uint16_t>(i), 0)->subscribed = true;
+        SimCentral c;
+        c.intervalUs = intervalsUs[i];
+        c.nextEventUs = static_cast<uint32_t>(i) * 1250;   // anchors spread
+        r.centrals.push_back(c);
+    }
+
+    uint32_t poolFree = poolSize;
+    bool pending = false;
+    uint32_t pendingCreatedUs = 0;
+    uint32_t offered = 0;
+
+    for (uint32_t now = 0; now < durationUs; now += 500) {
+        // Radio: connection events free buffers
+        for (SimCentral& c : r.centrals) {
+            while (now >= c.nextEventUs) {
+                for (uint32_t k = 0; k < PACKETS_PER_EVENT && !c.inFlight.empty(); ++k) {
+                    const uint32_t lat = c.nextEventUs - c.inFlight.front();
+                    c.inFlight.pop_front();
+                    ++poolFree;
+                    ++c.delivered;
+                    c.latencySumUs += lat;
+                    if (lat > c.latencyMaxUs) c.latencyMaxUs = lat;
+                }
+                c.nextEventUs += c.intervalUs;
+            }
+        }
+
+        // App: a new status value every period (latest value wins)
+        if (now % statusPeriodUs == 0) {
+            pending = true;
+            pendingCreatedUs = now;
+            ++offered;
+        }
+
+        // Server loop (1 ms)
+        if (pending && now % 1000 == 0) {
+            uint16_t targets[Table::capacity()];
+            const size_t n = rotate ? table.subscribers(targets) : table.handles(targets);
+            size_t issued = 0;
+            for (size_t i = 0; i < n; ++i) {
+                SimCentral& c = r.centrals[targets[i]];
+                if (poolFree == 0) {
+                    ++c.refused;
+                    continue;
+                }
+                --poolFree;
+                c.inFlight.push_back(pendingCreatedUs);
+                ++issued;
+            }
+            if (issued) pending = false;
+        }
+    }
+
+    double sum = 0;
+    double sumSq = 0;
+    for (const SimCentral& c : r.centrals) {
+        const double share = offered ? static_cast<double>(c.delivered) / offered : 0;
+        sum += share;
+        sumSq += share * share;
+    }
+    r.fairness = sumSq > 0 ? (sum * sum) / (r.centrals.size() * sumSq) : 1.0;
+    return r;
+}
+
+void printSim(const char* name, const SimResult& r) {
+    printf("BENCH multi-central %s: fairness=%.3f\n", name, r.fairness);
+    for (size_t i = 0; i < r.centrals.size(); ++i) {
+        const SimCentral& c = r.centrals[i];
+        printf("BENCH   central %zu interval=%.1f ms delivered=%lu refused=%lu latency avg=%.1f ms max=%.1f ms\n",
+               i, c.intervalUs / 1000.0, (unsigned long)c.delivered, (unsigned long)c.refused,
+               c.avgLatencyUs() / 1000.0, c.latencyMaxUs / 1000.0);
+    }
+}
+
+// Equal links competing for too few buffers: rotation spreads the misses.
+void testFairnessUnderBufferPressure() {
+    const std::vector<uint32_t> intervals = {30000, 30000, 30000};
+    const SimResult rotating = runMultiCentral(intervals, 4, 5000, 10000000, true);
+    const SimResult fixed = runMultiCentral(intervals, 4, 5000, 10000000, false);
+    printSim("equal links, rotating", rotating);
+    printSim("equal links, fixed order", fixed);
+
+    CHECK(rotating.fairness >= 0.98);
+    CHECK(rotating.fairness > fixed.fairness);
+    for (const SimCentral& c : rotating.centrals) CHECK(c.delivered > 0);
+}
+
+// Mixed controllers: a slow referee link must not hold the fast controller
+// link back, and each central's latency stays within a few of its intervals.
+void testLatencyPerCentral() {
+    const std::vector<uint32_t> intervals = {7500, 30000, 50000};
+    const SimResult r = runMultiCentral(intervals, 12, 20000, 10000000, true);
+    printSim("mixed intervals", r);
+
+    for (const SimCentral& c : r.centrals) {
+        CHECK(c.delivered > 0);
+        CHECK(c.latencyMaxUs <= 3 * c.intervalUs);
+    }
+    CHECK(r.centrals[0].avgLatencyUs() < r.centrals[2].avgLatencyUs());
+    CHECK_EQ(r.centrals[0].refused, 0);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testAddRemove);
+    RUN_TEST(testSingleController);
+    RUN_TEST(testSubscriberRotation);
+    RUN_TEST(testFairnessUnderBufferPressure);
+    RUN_TEST(testLatencyPerCentral);
+    return HostTest::result();
+}
@@ -0,0 +1,333 @@
+// Reconnect policy: backoff bounds, crowd spread, circuit breaker and its
+// decay, plus a reconnect storm compared with the previous fixed retry.
+
+#include "HostTest.h"
+
+#include "ble/ReconnectPolicy.h"
+
+namespace {
+
+using Policy = ReconnectPolicy<uint16_t, 2>;
+
+Policy makePolicy(const ReconnectConfig& config = ReconnectConfig()) {
+    Policy p;
+    p.configure(config);
+    p.seed(42);
+    return p;
+}
+
+// cap = min(maxMs, baseMs << (attempts - 1)), delay in [cap / 2, cap]
+void testBackoffBounds() {
+    const ReconnectConfig c;
+    for (uint32_t seed = 1; seed <= 50; ++seed) {
+        Policy p = makePolicy();
+        p.seed(seed);
+        uint32_t cap = c.baseMs;
+        for (int i = 0; i < 10; ++i) {
+            const uint32_t d = p.onFailure(1, ConnectFailure::TIMEOUT, 0);
+            CHECK(d >= cap / 2);
+            CHECK(d <= cap);
+            cap = cap * 2 > c.maxMs ? c.maxMs : cap * 2;
+        }
+    }
+
+    // REJECTED counts double
+    Policy p = makePolicy();
+    p.onFailure(1, ConnectFailure::REJECTED, 0);
+    CHECK_EQ(p.attempts(), 2);
+    p.onFailure(1, ConnectFailure::TIMEOUT, 0);
+    CHECK_EQ(p.attempts(), 3);
+    CHECK_EQ(p.stats().failures[static_cast<size_t>(ConnectFailure::REJECTED)], 1);
+    CHECK_EQ(p.stats().failures[static_cast<size_t>(ConnectFailure::TIMEOUT)], 1);
+}
+
+// Stable link lost: backoff reset, first retry within the crowd spread.
+void testLinkLostSpread() {
+    const ReconnectConfig c;
+    const uint16_t crowds[] = {0, 1, 12, 48, 500};
+    for (uint16_t crowd : crowds) {
+        uint32_t spread = c.spreadPerHeadMs * crowd;
+        if (spread < c.minSpreadMs) spread = c.minSpreadMs;
+        if (spread > c.maxSpreadMs) spread = c.maxSpreadMs;
+
+        Policy p = makePolicy();
+        p.setCrowd(crowd);
+        uint32_t maxDelay = 0;
+        for (int i = 0; i < 200; ++i) {
+            p.onFailure(1, ConnectFailure::TIMEOUT, 0);
+            p.onConnected(1000);
+            const uint32_t d = p.onLinkLost(1, 1000 + c.stableLinkMs);
+            CHECK_EQ(p.attempts(), 0);
+            if (d > maxDelay) maxDelay = d;
+        }
+        CHECK(maxDelay <= spread);
+        CHECK(maxDelay > spread / 2);   // actually spread, not bunched at 0
+    }
+}
+
+// Lost before stableLinkMs: flapping, counted as REJECTED.
+void testFlappingLink() {
+    Policy p = makePolicy();
+    p.onConnected(1000);
+    const uint32_t d = p.onLinkLost(1, 1000 + ReconnectConfig().stableLinkMs - 1);
+    CHECK_EQ(p.attempts(), 2);
+    CHECK(d >= ReconnectConfig().baseMs);
+    CHECK_EQ(p.stats().linksLost, 1);
+    CHECK_EQ(p.stats().failures[static_cast<size_t>(ConnectFailure::REJECTED)], 1);
+}
+
+void testBreakerTripAndProbe() {
+    const ReconnectConfig c;
+    Policy p = makePolicy();
+    uint32_t now = 0;
+    for (int i = 0; i < c.breakerStrikes - 1; ++i) p.onFailure(1, ConnectFailure::TIMEOUT, now += 1000);
+    CHECK(p.allows(1, now));
+    CHECK_EQ(p.msUntilAllowed(1, now), 0);
+
+    p.onFailure(1, ConnectFailure::TIMEOUT, now += 1000);
+    CHECK(!p.allows(1, now));
+    CHECK(p.allows(2, now));   // per target
+    CHECK_EQ(p.msUntilAllowed(1, now), c.breakerOpenMs);
+    CHECK_EQ(p.msUntilAllowed(1, now + 5000), c.breakerOpenMs - 5000);
+    CHECK_EQ(p.stats().breakerTrips, 1);
+
+    // One probe when it expires; failing it trips again, for twice as long
+    now += c.breakerOpenMs;
+    CHECK(p.allows(1, now));
+    p.onFailure(1, ConnectFailure::TIMEOUT, now);
+    CHECK_EQ(p.msUntilAllowed(1, now), 2 * c.breakerOpenMs);
+
+    // Doubling stops at breakerMaxOpenMs
+    for (int i = 0; i < 6; ++i) {
+        now += p.msUntilAllowed(1, now);
+        p.onFailure(1, ConnectFailure::TIMEOUT, now);
+    }
+    CHECK_EQ(p.msUntilAllowed(1, now), c.breakerMaxOpenMs);
+
+    // Not a BBLH: blocked on the first failure. Refused twice: blocked
+    p.onFailure(2, ConnectFailure::SERVICE_MISSING, now);
+    CHECK(!p.allows(2, now));
+
+    Policy r = makePolicy();
+    r.onFailure(4, ConnectFailure::REJECTED, 0);
+    CHECK(r.allows(4, 0));
+    r.onFailure(4, ConnectFailure::REJECTED, 100);
+    CHECK(!r.allows(4, 100));
+}
+
+// A stable link clears the breaker of its head.
+void testStableLinkClearsBreaker() {
+    Policy p = makePolicy();
+    p.onFailure(1, ConnectFailure::SERVICE_MISSING, 0);
+    CHECK(!p.allows(1, 1000));
+    p.onConnected(ReconnectConfig().breakerOpenMs);
+    const uint32_t lost = ReconnectConfig().breakerOpenMs + ReconnectConfig().stableLinkMs;
+    p.onLinkLost(1, lost);
+    p.onFailure(1, ConnectFailure::TIMEOUT, lost + 100);   // one strike, from zero
+    CHECK(p.allows(1, lost + 100));
+}
+
+// Strikes are forgotten after breakerQuietMs without a failure.
+void testStrikesDecay() {
+    const ReconnectConfig c;
+    Policy p = makePolicy();
+    uint32_t now = 0;
+    for (int i = 0; i < c.breakerStrikes - 1; ++i) p.onFailure(1, ConnectFailure::TIMEOUT, now += 1000);
+    now += c.breakerQuietMs - 1;
+    p.onFailure(1, ConnectFailure::TIMEOUT, now);   // not quiet long enough: trips
+    CHECK(!p.allows(1, now));
+
+    // Quiet from the end of the open period: back to zero strikes and to
+    // the base open time
+    for (int i = 0; i < 3; ++i) {
+        now += p.msUntilAllowed(1, now);
+        p.onFailure(1, ConnectFailure::TIMEOUT, now);
+    }
+    CHECK_EQ(p.msUntilAllowed(1, now), 8 * c.breakerOpenMs);
+    now += p.msUntilAllowed(1, now) + c.breakerQuietMs;
+    p.onFailure(1, ConnectFailure::TIMEOUT, now);
+    CHECK(p.allows(1, now));
+    for (int i = 0; i < c.breakerStrikes - 1; ++i) p.onFailure(1, ConnectFailure::TIMEOUT, now += 1000);
+    CHECK(!p.allows(1, now));
+    CHECK_EQ(p.msUntilAllowed(1, now), c.breakerOpenMs);
+
+    // Spread-out timeouts never add up to a trip
+    Policy q = makePolicy();
+    for (uint32_t t = 0; t < 20; ++t) q.onFailure(3, ConnectFailure::TIMEOUT, t * c.breakerQuietMs);
+    CHECK(q.allows(3, 20 * c.breakerQuietMs));
+    CHECK_EQ(q.stats().breakerTrips, 0);
+}
+
+// Full table: the target that failed longest ago makes room.
+void testTargetEviction() {
+    Policy p = makePolicy();
+    p.onFailure(1, ConnectFailure::SERVICE_MISSING, 1000);
+    p.onFailure(2, ConnectFailure::SERVICE_MISSING, 2000);
+    p.onFailure(3, ConnectFailure::TIMEOUT, 3000);
+    CHECK(p.allows(1, 3000));    // evicted
+    CHECK(!p.allows(2, 3000));
+    CHECK(p.allows(3, 3000));
+}
+
+// =========================
+// Reconnect storm
+// =========================
+// `controllers` BBLC, each paired with its own head, all lose their
+// link at t = 0 (RF glitch). Each one rescans, finds its head after
+// 100-400 ms and attempts a connection lasting 60 ms. Attempts compete
+// for the advertising channels (ALOHA-like): each other attempt in
+// flight collides with ours one time in collisionOneIn, so with k
+// overlapping the odds are (1 - 1/collisionOneIn)^k. A failed attempt
+// ends as a TIMEOUT. Every controller sees all the heads.
+// usePolicy = false replays the previous behaviour: a fixed 250 ms in
+// DISCONNECTED after every failure, no jitter.
+struct StormResult {
+    uint32_t allConnectedMs = 0;   // UINT32_MAX if not done within the time limit
+    uint32_t attempts = 0;
+    uint32_t breakerTrips = 0;
+};
+
+StormResult runStorm(uint16_t controllers, bool usePolicy, uint32_t seed, uint32_t collisionOneIn) {
+    static constexpr uint16_t MAX_NODES = 128;
+    static constexpr uint32_t ATTEMPT_MS = 60;
+    static constexpr uint32_t FIXED_RETRY_MS = 250;
+    static constexpr uint32_t LIMIT_MS = 300000;
+    const ReconnectConfig config;
+
+    enum class Phase : uint8_t { WAITING, ATTEMPTING, CONNECTED };
+    struct Node {
+        Phase phase;
+        uint32_t at;   // WAITING: attempt start, ATTEMPTING: attempt end
+        Policy policy;
+    };
+    static Node nodes[MAX_NODES];
+
+    HostTest::Rng rng(seed);
+    auto discovery = [&rng]() { return static_cast<uint32_t>(rng.range(100, 400)); };
+
+    for (uint16_t i = 0; i < controllers; ++i) {
+        Node& n = nodes[i];
+        n.policy = Policy();
+        n.policy.configure(config);
+        n.policy.seed(seed * 7919u + i + 1);
+        n.policy.onConnected(0);
+        n.policy.setCrowd(controllers);
+
+        // Links were up for a long while: the loss is not flapping
+        const uint32_t wait = usePolicy ? n.policy.onLinkLost(i, config.stableLinkMs) : FIXED_RETRY_MS;
+        n.phase = Phase::WAITING;
+        n.at = wait + discovery();
+    }
+
+    StormResult r;
+    uint16_t connected = 0;
+    for (uint32_t now = 0; now < LIMIT_MS && connected < controllers; ++now) {
+        for (uint16_t i = 0; i < controllers; ++i) {
+            Node& n = nodes[i];
+            if (n.phase == Phase::WAITING && now >= n.at) {
+                n.phase = Phase::ATTEMPTING;
+                n.at = now + ATTEMPT_MS;
+                ++r.attempts;
+            }
+        }
+
+        for (uint16_t i = 0; i < controllers; ++i) {
+            Node& n = nodes[i];
+            if (n.phase != Phase::ATTEMPTING || now != n.at) continue;
+
+            bool collided = false;
+            for (uint16_t j = 0; j < controllers && !collided; ++j) {
+                if (j != i && nodes[j].phase == Phase::ATTEMPTING) collided = rng.oneIn(collisionOneIn);
+            }
+            if (!collided) {
+                n.phase = Phase::CONNECTED;
+                if (++connected == controllers) r.allConnectedMs = now;
+                continue;
+            }
+
+            const uint32_t wait = usePolicy
+                ? n.policy.onFailure(i, ConnectFailure::TIMEOUT, now)
+                : FIXED_RETRY_MS;
+            n.phase = Phase::WAITING;
+            // Breaker open on our own head: wait for it before trying again
+            const uint32_t blocked = n.policy.msUntilAllowed(i, now);
+            n.at = now + (blocked > wait ? blocked : wait) + discovery();
+        }
+    }
+
+    if (connected < controllers) r.allConnectedMs = UINT32_MAX;
+    for (uint16_t i = 0; i < controllers; ++i) r.breakerTrips += nodes[i].policy.stats().breakerTrips;
+    return r;
+}
+
+struct StormAverage {
+    double allConnectedS = 0;
+    double attempts = 0;
+    uint32_t unfinished = 0;
+    uint32_t breakerTrips = 0;
+};
+
+StormAverage averageStorm(uint16_t controllers, bool usePolicy, uint32_t collisionOneIn) {
+    static constexpr uint32_t SEEDS = 20;
+    StormAverage a;
+    for (uint32_t seed = 1; seed <= SEEDS; ++seed) {
+        const StormResult r = runStorm(controllers, usePolicy, seed, collisionOneIn);
+        if (r.allConnectedMs == UINT32_MAX) {
+            ++a.unfinished;
+            continue;
+        }
+        a.allConnectedS += r.allConnectedMs / 1000.0 / SEEDS;
+        a.attempts += static_cast<double>(r.attempts) / SEEDS;
+        a.breakerTrips += r.breakerTrips;
+    }
+    return a;
+}
+
+// Same time to reconnect a whole hall as the fixed retry, or better, with
+// far fewer attempts on air. At n=48 and 1/2 collision odds the 4 s
+// backoff cap left a few unlucky controllers waiting long after the rest;
+// at 2 s the policy matches the fixed retry with half the attempts.
+void testReconnectStorm() {
+    struct Case {
+        uint16_t controllers;
+        uint32_t collisionOneIn;
+        double maxSlowdown;    // policy time / fixed retry time
+        double maxAttempts;    // policy attempts / fixed retry attempts
+    };
+    const Case cases[] = {
+        {12, 4, 1.00, 1.00},
+        {48, 4, 1.10, 0.60},
+        {96, 4, 1.05, 0.35},
+        {12, 2, 1.00, 1.00},
+        {48, 2, 1.05, 0.50},
+        {96, 2, 0.60, 0.15},
+    };
+
+    for (const Case& c : cases) {
+        const StormAverage policy = averageStorm(c.controllers, true, c.collisionOneIn);
+        const StormAverage fixed = averageStorm(c.controllers, false, c.collisionOneIn);
+        printf("BENCH reconnect storm n=%u odds 1/%lu: policy %.2f s / %.0f attempts, fixed retry %.2f s / %.0f attempts\n",
+               static_cast<unsigned>(c.controllers), (unsigned long)c.collisionOneIn,
+               policy.allConnectedS, policy.attempts, fixed.allConnectedS, fixed.attempts);
+
+        CHECK_EQ(policy.unfinished, 0);
+        CHECK_EQ(fixed.unfinished, 0);
+        CHECK_EQ(policy.breakerTrips, 0);   // contention alone never blocks a head
+        CHECK(policy.allConnectedS <= fixed.allConnectedS * c.maxSlowdown);
+        CHECK(policy.attempts <= fixed.attempts * c.maxAttempts);
+    }
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testBackoffBounds);
+    RUN_TEST(testLinkLostSpread);
+    RUN_TEST(testFlappingLink);
+    RUN_TEST(testBreakerTripAndProbe);
+    RUN_TEST(testStableLinkClearsBreaker);
+    RUN_TEST(testStrikesDecay);
+    RUN_TEST(testTargetEviction);
+    RUN_TEST(testReconnectStorm);
+    return HostTest::result();
+}
@@ -0,0 +1,430 @@
+// Rip gesture detector: trigger / reject rules, strength mapping, the
+// FIFO pipeline against a fake IMU, and a scored run on a synthetic
+// hand-held trace (hits, false positives, latency, CPU cost).
+
+#include "HostTest.h"
+
+#include <vector>
+
+#include "motion/RipPipeline.h"
+
+namespace {
+
+static constexpr uint32_t PERIOD_US = 600;   // LSM6DS3 at 1.66 kHz
+static constexpr int32_t LSB_PER_G = 2048;
+
+ImuSample rest() {
+    ImuSample s {};
+    s.az = LSB_PER_G;
+    return s;
+}
+
+// Feeds `count` samples, one at a time, from time t; returns the events.
+template<typename Shape>
+std::vector<RipEvent> feed(RipDetector& d, uint32_t& t, size_t count, Shape shape) {
+    std::vector<RipEvent> found;
+    for (size_t i = 0; i < count; ++i, t += PERIOD_US) {
+        const ImuSample s = shape(i);
+        RipEvent e[2];
+        const size_t n = d.process(&s, 1, t, PERIOD_US, e, 2);
+        found.insert(found.end(), e, e + n);
+    }
+    return found;
+}
+
+std::vector<RipEvent> settle(RipDetector& d, uint32_t& t) {
+    return feed(d, t, 500, [](size_t) { return rest(); });
+}
+
+// Square pulse of `g` on X for `samples` samples.
+std::vector<RipEvent> pulse(RipDetector& d, uint32_t& t, int32_t g, size_t samples) {
+    return feed(d, t, samples, [g](size_t) {
+        ImuSample s = rest();
+        s.ax = static_cast<int16_t>(g * LSB_PER_G);
+        return s;
+    });
+}
+
+void testQuietNeverFires() {
+    RipDetector d;
+    d.configure(RipConfig());
+    uint32_t t = 0;
+    CHECK(settle(d, t).empty());
+    CHECK(d.envelope() < RipConfig().offThreshold);
+}
+
+// A short knock crosses onThreshold but falls back before confirmation.
+void testKnockRejected() {
+    RipDetector d;
+    d.configure(RipConfig());
+    uint32_t t = 0;
+    settle(d, t);
+    CHECK(pulse(d, t, 8, 2).empty());
+    CHECK(settle(d, t).empty());
+}
+
+void testRipFiresOnceWithinRefractory() {
+    RipDetector d;
+    d.configure(RipConfig());
+    uint32_t t = 0;
+    settle(d, t);
+
+    const uint32_t start = t;
+    std::vector<RipEvent> e = pulse(d, t, 5, 40);
+    CHECK_EQ(e.size(), 1u);
+    if (e.size() == 1) {
+        CHECK(e[0].onsetUs >= start);
+        CHECK(e[0].detectedUs - e[0].onsetUs >= (RipConfig().confirmSamples - 1) * PERIOD_US);
+        CHECK(e[0].detectedUs - start < 10 * PERIOD_US);
+    }
+
+    // Second pull 100 ms later: still locked out
+    feed(d, t, 100, [](size_t) { return rest(); });
+    CHECK(pulse(d, t, 5, 40).empty());
+
+    // After the refractory period and a settled envelope: armed again
+    settle(d, t);
+    settle(d, t);
+    CHECK_EQ(pulse(d, t, 5, 40).size(), 1u);
+}
+
+// Held above offThreshold past the refractory period: no new event until
+// the envelope comes down.
+void testMustSettleBeforeRearm() {
+    RipDetector d;
+    d.configure(RipConfig());
+    uint32_t t = 0;
+    settle(d, t);
+    // Alternating sign keeps the high-pass output large for the whole run
+    const std::vector<RipEvent> e = feed(d, t, 1500, [](size_t i) {
+        ImuSample s = rest();
+        s.ax = static_cast<int16_t>(((i / 4) & 1 ? -5 : 5) * LSB_PER_G);
+        return s;
+    });
+    CHECK_EQ(e.size(), 1u);
+}
+
+void testStrengthMapping() {
+    RipConfig c;
+    uint8_t last = 0;
+    for (int32_t g = 4; g <= 10; ++g) {
+        RipDetector d;
+        d.configure(c);
+        uint32_t t = 0;
+        settle(d, t);
+        const std::vector<RipEvent> e = pulse(d, t, g, 40);
+        CHECK_EQ(e.size(), 1u);
+        if (e.empty()) continue;
+        CHECK(e[0].peak >= c.onThreshold);
+        CHECK(e[0].strength >= last);   // monotonic in the pull
+        last = e[0].strength;
+    }
+    CHECK_EQ(last, 255);
+
+    // Degenerate span: anything confirmed is full strength
+    c.fullScale = c.onThreshold;
+    RipDetector d;
+    d.configure(c);
+    uint32_t t = 0;
+    settle(d, t);
+    const std::vector<RipEvent> e = pulse(d, t, 4, 40);
+    CHECK_EQ(e.size(), 1u);
+    if (!e.empty()) CHECK_EQ(e[0].strength, 255);
+}
+
+// Batch timestamps: the last sample is at lastUs, earlier ones backwards.
+void testBatchTimestamps() {
+    RipDetector one;
+    RipDetector batched;
+    one.configure(RipConfig());
+    batched.configure(RipConfig());
+
+    std::vector<ImuSample> trace(600, rest());
+    for (size_t i = 400; i < 440; ++i) trace[i].ax = 6 * LSB_PER_G;
+
+    std::vector<RipEvent> a;
+    for (size_t i = 0; i < trace.size(); ++i) {
+        RipEvent e[2];
+        const size_t n = one.process(&trace[i], 1, static_cast<uint32_t>(i) * PERIOD_US, PERIOD_US, e, 2);
+        a.insert(a.end(), e, e + n);
+    }
+    std::vector<RipEvent> b;
+    for (size_t i = 0; i < trace.size(); i += 24) {
+        RipEvent e[2];
+        const uint32_t lastUs = static_cast<uint32_t>(i + 23) * PERIOD_US;
+        const size_t n = batched.process(&trace[i], 24, lastUs, PERIOD_US, e, 2);
+        b.insert(b.end(), e, e + n);
+    }
+
+    CHECK_EQ(a.size(), 1u);
+    CHECK_EQ(b.size(), 1u);
+    if (a.size() == 1 && b.size() == 1) {
+        CHECK_EQ(a[0].onsetUs, b[0].onsetUs);
+        CHECK_EQ(a[0].detectedUs, b[0].detectedUs);
+        CHECK_EQ(a[0].strength, b[0].strength);
+    }
+}
+
+// =========================
+// Pipeline
+// =========================
+// FIFO of recorded samples, drained by readFifo(), clock advanced by hand.
+struct FakeImu {
+    std::vector<ImuSample> fifo;
+    uint32_t clockUs = 0;
+    bool lost = false;
+    bool present = true;
+
+    bool begin() { return present; }
+    uint32_t samplePeriodUs() const { return PERIOD_US; }
+    size_t available() { return fifo.size(); }
+    size_t readFifo(ImuSample* out, size_t max) {
+        const size_t n = max < fifo.size() ? max : fifo.size();
+        for (size_t i = 0; i < n; ++i) out[i] = fifo[i];
+        fifo.erase(fifo.begin(), fifo.begin() + static_cast<std::ptrdiff_t>(n));
+        return n;
+    }
+    bool overrun() {
+        const bool o = lost;
+        lost = false;
+        return o;
+    }
+    uint32_t nowUs() { return clockUs; }
+};
+
+void testPipelineDrainsAndDates() {
+    FakeImu imu;
+    RipPipeline<FakeImu, 16> pipe(imu);
+    CHECK(pipe.begin());
+
+    for (int i = 0; i < 500; ++i) imu.fifo.push_back(rest());
+    for (int i = 0; i < 40; ++i) {
+        ImuSample s = rest();
+        s.ax = 6 * LSB_PER_G;
+        imu.fifo.push_back(s);
+    }
+    for (int i = 0; i < 60; ++i) imu.fifo.push_back(rest());
+    imu.clockUs = 1000000;   // newest sample
+
+    std::vector<RipEvent> got;
+    const size_t n = pipe.poll([&](const RipEvent& e) { got.push_back(e); });
+    CHECK_EQ(n, 1u);
+    CHECK_EQ(got.size(), 1u);
+    CHECK(imu.fifo.empty());
+    CHECK_EQ(pipe.stats().samples, 600);
+    CHECK_EQ(pipe.stats().batches, 38);   // 600 / 16, rounded up
+    CHECK_EQ(pipe.stats().events, 1);
+
+    // Sample 500 is 99 periods before the newest one
+    if (!got.empty()) {
+        const uint32_t pulseStart = imu.clockUs - 99 * PERIOD_US;
+        CHECK(got[0].onsetUs >= pulseStart);
+        CHECK(got[0].onsetUs < pulseStart + 4 * PERIOD_US);
+    }
+
+    CHECK_EQ(pipe.poll([](const RipEvent&) {}), 0u);   // empty FIFO
+}
+
+void testPipelineOverrunAndAbsentImu() {
+    FakeImu imu;
+    RipPipeline<FakeImu, 16> pipe(imu);
+    pipe.begin();
+    for (int i = 0; i < 100; ++i) imu.fifo.push_back(rest());
+    pipe.poll([](const RipEvent&) {});
+
+    // FIFO overflowed: the detector restarts from the next sample (no
+    // step response on the jump to a new orientation)
+    imu.lost = true;
+    for (int i = 0; i < 100; ++i) {
+        ImuSample s {};
+        s.ax = 10 * LSB_PER_G;
+        imu.fifo.push_back(s);
+    }
+    CHECK_EQ(pipe.poll([](const RipEvent&) {}), 0u);
+    CHECK_EQ(pipe.stats().overruns, 1);
+
+    FakeImu missing;
+    missing.present = false;
+    RipPipeline<FakeImu, 16> none(missing);
+    CHECK(!none.begin());
+    missing.fifo.push_back(rest());
+    CHECK_EQ(none.poll([](const RipEvent&) {}), 0u);
+    CHECK_EQ(missing.fifo.size(), 1u);
+}
+
+// =========================
+// Synthetic trace
+// =========================
+// Controller held in hand: gravity on Z, sensor noise, a slow swing,
+// a knock every 1.3 s (2 samples at 8 g) and a moderate shake every
+// 3.1 s (30 ms at ~1.8 g), plus a rip every 2 s whose peak goes from
+// 4 g to 10 g (20 ms rise, 25 ms fall, with a gyro twist).
+class RipTraceSynth {
+public:
+    static constexpr uint32_t RIP_PERIOD_US = 2000000;
+    static constexpr uint32_t RIP_OFFSET_US = 700000;
+    static constexpr uint32_t RIP_LENGTH_US = 45000;
+
+    explicit RipTraceSynth(uint32_t periodUs, uint32_t seed = 1) : periodUs_(periodUs), rng_(seed) {}
+
+    uint32_t nowUs() const { return t_; }
+
+    // Gesture start of rip n
+    static uint32_t ripStartUs(uint32_t n) { return RIP_OFFSET_US + n * RIP_PERIOD_US; }
+
+    ImuSample next() {
+        const uint32_t t = t_;
+        t_ += periodUs_;
+
+        // Slow swing, 1 s triangle of +-0.5 g on X
+        const int32_t phase = static_cast<int32_t>(t % 1000000) - 500000;
+        const int32_t swing = ((phase < 0 ? -phase : phase) - 250000) * (LSB_PER_G / 2) / 250000;
+
+        int32_t ax = swing + rng_.range(-40, 40);
+        int32_t ay = rng_.range(-40, 40);
+        int32_t az = LSB_PER_G + rng_.range(-40, 40);
+        int32_t gx = rng_.range(-20, 20);
+        int32_t gy = rng_.range(-20, 20);
+        int32_t gz = rng_.range(-20, 20);
+
+        // Knock: two samples at 8 g
+        if ((t + 900000) % 1300000 < 2 * periodUs_) ay += 8 * LSB_PER_G;
+
+        // Shake: 30 ms square wave at ~1.8 g
+        const uint32_t shake = t % 3100000;
+        if (shake < 30000) ax += ((shake / 5000) & 1 ? -1 : 1) * (LSB_PER_G * 9 / 5);
+
+        // Rip: triangular pulse on X plus a twist around Z
+        const uint32_t rip = (t + RIP_PERIOD_US - RIP_OFFSET_US) % RIP_PERIOD_US;
+        if (rip < RIP_LENGTH_US) {
+            const uint32_t n = (t - RIP_OFFSET_US) / RIP_PERIOD_US;
+            const int32_t peak = (4 + static_cast<int32_t>(n % 7)) * LSB_PER_G;
+            const int32_t shape = rip < 20000
+                ? static_cast<int32_t>(rip) * 1000 / 20000
+                : static_cast<int32_t>(RIP_LENGTH_US - rip) * 1000 / 25000;
+            ax += peak * shape / 1000;
+            gz += 11440 * shape / 1000;   // ~800 dps
+        }
+
+        ImuSample s;
+        s.ax = clamp16(ax);
+        s.ay = clamp16(ay);
+        s.az = clamp16(az);
+        s.gx = clamp16(gx);
+        s.gy = clamp16(gy);
+        s.gz = clamp16(gz);
+        return s;
+    }
+
+private:
+    static int16_t clamp16(int32_t v) {
+        return static_cast<int16_t>(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+    }
+
+    uint32_t periodUs_;
+    HostTest::Rng rng_;
+    uint32_t t_ = 0;
+};
+
+struct TraceScore {
+    uint32_t gestures = 0;
+    uint32_t hits = 0;
+    uint32_t falsePositives = 0;
+    uint64_t latencyTotalUs = 0;
+    uint32_t latencyMaxUs = 0;
+    uint32_t strengthMin = 255;
+    uint32_t strengthMax = 0;
+    uint64_t cpuUs = 0;
+    uint32_t samples = 0;
+};
+
+// Runs the detector over the trace in FIFO-sized batches. An event whose
+// onset lands within a rip counts as a hit; latency runs from the start of
+// the rip to the end of the batch that produced the event, i.e. when the
+// firmware gets to know about it.
+template<size_t BATCH>
+TraceScore runTrace(uint32_t durationUs, uint32_t seed) {
+    RipDetector detector;
+    detector.configure(RipConfig());
+    RipTraceSynth synth(PERIOD_US, seed);
+    TraceScore r;
+    while (RipTraceSynth::ripStartUs(r.gestures) + RipTraceSynth::RIP_LENGTH_US < durationUs) ++r.gestures;
+
+    uint32_t nextLabel = 0;
+    ImuSample batch[BATCH];
+    RipEvent events[4];
+    while (synth.nowUs() < durationUs) {
+        for (size_t i = 0; i < BATCH; ++i) batch[i] = synth.next();
+        const uint32_t lastUs = synth.nowUs() - PERIOD_US;
+
+        const uint64_t t0 = HostTest::nowUs();
+        const size_t n = detector.process(batch, BATCH, lastUs, PERIOD_US, events, 4);
+        r.cpuUs += HostTest::nowUs() - t0;
+        r.samples += BATCH;
+
+        for (size_t i = 0; i < n; ++i) {
+            const RipEvent& e = events[i];
+            while (nextLabel < r.gestures &&
+                   e.onsetUs > RipTraceSynth::ripStartUs(nextLabel) + RipTraceSynth::RIP_LENGTH_US) {
+                ++nextLabel;   // passed without a detection: miss
+            }
+            const uint32_t label = RipTraceSynth::ripStartUs(nextLabel);
+            if (nextLabel < r.gestures && e.onsetUs >= label) {
+                const uint32_t latency = lastUs - label;
+                ++r.hits;
+                r.latencyTotalUs += latency;
+                if (latency > r.latencyMaxUs) r.latencyMaxUs = latency;
+                if (e.strength < r.strengthMin) r.strengthMin = e.strength;
+                if (e.strength > r.strengthMax) r.strengthMax = e.strength;
+                ++nextLabel;
+            } else {
+                ++r.falsePositives;
+            }
+        }
+    }
+    return r;
+}
+
+void printTrace(const char* name, const TraceScore& r) {
+    printf("BENCH rip trace %s: hits %lu/%lu fp=%lu latency avg=%lu max=%lu us, strength %lu..%lu, %.1f ns/sample\n",
+           name, (unsigned long)r.hits, (unsigned long)r.gestures, (unsigned long)r.falsePositives,
+           (unsigned long)(r.hits ? r.latencyTotalUs / r.hits : 0), (unsigned long)r.latencyMaxUs,
+           (unsigned long)r.strengthMin, (unsigned long)r.strengthMax,
+           r.samples ? r.cpuUs * 1000.0 / r.samples : 0.0);
+}
+
+void testSyntheticTrace() {
+    const TraceScore fifo = runTrace<16>(60000000, 1);
+    const TraceScore single = runTrace<1>(60000000, 1);
+    const TraceScore other = runTrace<16>(60000000, 12345);
+    printTrace("batch=16", fifo);
+    printTrace("batch=1", single);
+    printTrace("batch=16 seed=12345", other);
+
+    CHECK_EQ(fifo.gestures, 30);
+    for (const TraceScore* r : {&fifo, &single, &other}) {
+        CHECK_EQ(r->hits, r->gestures);
+        CHECK_EQ(r->falsePositives, 0);
+        CHECK(r->strengthMin < r->strengthMax);   // 4 g and 10 g pulls differ
+    }
+
+    // Same detections whatever the batching; the FIFO batch only adds its
+    // own length (16 samples, 9.6 ms) to the latency
+    CHECK(single.latencyMaxUs <= 20000);
+    CHECK(fifo.latencyMaxUs <= single.latencyMaxUs + 16 * PERIOD_US);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testQuietNeverFires);
+    RUN_TEST(testKnockRejected);
+    RUN_TEST(testRipFiresOnceWithinRefractory);
+    RUN_TEST(testMustSettleBeforeRearm);
+    RUN_TEST(testStrengthMapping);
+    RUN_TEST(testBatchTimestamps);
+    RUN_TEST(testPipelineDrainsAndDates);
+    RUN_TEST(testPipelineOverrunAndAbsentImu);
+    RUN_TEST(testSyntheticTrace);
+    return HostTest::result();
+}